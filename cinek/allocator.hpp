@@ -34,6 +34,7 @@
 #include "types.hpp"
 
 #include <memory>
+#include <limits>
 
 namespace cinek {
 
@@ -130,21 +131,25 @@ void cinek_free_aligned(int heap, void* ptr);
 class Allocator
 {
 public:
-	Allocator(): _heap(0) {}
+	Allocator(): _heap(0), _callbacks(nullptr) {}
     Allocator(Allocator&& other) :
-        _heap(other._heap)
+        _heap(other._heap),
+        _callbacks(other._callbacks)
     {
     }
     Allocator& operator=(Allocator&& other)
     {
         _heap = other._heap;
+        _callbacks = other._callbacks;
         other._heap = 0;
+        other._callbacks = nullptr;
         return *this;
     }
     Allocator(const Allocator& other) :
-        _heap(other._heap) {}
+        _heap(other._heap), _callbacks(other._callbacks) {}
     Allocator& operator=(const Allocator& other) {
         _heap = other._heap;
+        _callbacks = other._callbacks;
         return *this;
     }
 	/**
@@ -154,13 +159,23 @@ public:
 	 *                   	 allocCallbacks.
 	 */
 	Allocator(int heap)
-		: _heap(heap) {}
+		: _heap(heap), _callbacks(nullptr) {}
+    /**
+     * Constructor.  Allocates using the supplied callbacks instead of a
+     * cinek heap, leaving the process-wide heaps untouched.
+     * @param callbacks      The callbacks, which must outlive this
+     *                       Allocator and its copies.
+     */
+    explicit Allocator(const cinek_memory_callbacks* callbacks)
+        : _heap(0), _callbacks(callbacks) {}
 	/**
 	 * Allocates a block of memory of the supplied size.
 	 * @param  size Size of the memory block to allocate.
 	 * @return A pointer to the allocated block or nullptr.
 	 */
 	void* alloc(size_t size) {
+        if (_callbacks)
+            return (*_callbacks->alloc)(_callbacks->context, size);
 		return cinek_alloc(_heap, size);
 	}
 	/**
@@ -170,6 +185,8 @@ public:
 	 * @return A pointer to the allocated block or nullptr.
 	 */
     void* allocAligned(size_t size, size_t align) {
+        if (_callbacks)
+            return (*_callbacks->alloc_aligned)(_callbacks->context, size, align);
         return cinek_alloc_aligned(_heap, size, align);
     }
 	/**
@@ -204,7 +221,10 @@ public:
 	 * @param ptr Pointer to the memory block to free.
 	 */
 	void free(void* ptr) {
-        cinek_free(_heap, ptr);
+        if (!_callbacks)
+            cinek_free(_heap, ptr);
+        else if (ptr)
+            (*_callbacks->free)(_callbacks->context, ptr);
 	}
 
     /**
@@ -212,22 +232,26 @@ public:
     * @param ptr Pointer to the memory block to free
     */
     void freeAligned(void* ptr) {
-        cinek_free_aligned(_heap, ptr);
+        if (!_callbacks)
+            cinek_free_aligned(_heap, ptr);
+        else if (ptr)
+            (*_callbacks->free_aligned)(_callbacks->context, ptr);
     }
 
 private:
     friend bool operator==(const Allocator& lha, const Allocator& rha);
     friend bool operator!=(const Allocator& lha, const Allocator& rha);
     int _heap;
+    const cinek_memory_callbacks* _callbacks;
 };
 /** @cond */
 inline bool operator==(const Allocator& lha, const Allocator& rha)
 {
-    return lha._heap == rha._heap;
+    return lha._heap == rha._heap && lha._callbacks == rha._callbacks;
 }
 inline bool operator!=(const Allocator& lha, const Allocator& rha)
 {
-    return lha._heap != rha._heap;
+    return !(lha == rha);
 }
 /** @endcond */
 
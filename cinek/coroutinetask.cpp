@@ -0,0 +1,147 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/coroutinetask.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Tasks implemented as C++20 coroutines
+ * @copyright Cinekine
+ */
+
+#include "cinek/coroutinetask.hpp"
+#include "cinek/debug.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <cstdlib>
+
+namespace cinek {
+
+namespace {
+    //  precedes each routine frame so that frames can be freed without
+    //  knowledge of the scheduler they were allocated from
+    struct alignas(std::max_align_t) RoutineFrameHeader
+    {
+        Allocator allocator;
+    };
+}
+
+void* TaskRoutine::promise_type::allocFrame
+(
+    Allocator allocator,
+    size_t size
+) noexcept
+{
+    auto header = reinterpret_cast<RoutineFrameHeader*>(
+        allocator.alloc(sizeof(RoutineFrameHeader) + size));
+    if (!header)
+        return nullptr;
+    ::new(header) RoutineFrameHeader { allocator };
+    return header + 1;
+}
+
+void TaskRoutine::promise_type::freeFrame(void* ptr) noexcept
+{
+    auto header = reinterpret_cast<RoutineFrameHeader*>(ptr) - 1;
+    Allocator allocator = header->allocator;
+    header->~RoutineFrameHeader();
+    allocator.free(header);
+}
+
+void TaskRoutine::promise_type::unhandled_exception() const noexcept
+{
+    CK_ASSERT(false);
+    std::abort();
+}
+
+void TaskRoutine::TaskAwaiter::await_suspend(Handle h) noexcept
+{
+    auto& promise = h.promise();
+    promise.waitPoll = [](void* awaiter) -> bool {
+        auto self = reinterpret_cast<TaskAwaiter*>(awaiter);
+        return self->await_ready();
+    };
+    promise.waiter = this;
+}
+
+TaskRoutine::TaskRoutine(TaskRoutine&& other) noexcept :
+    _handle(other._handle)
+{
+    other._handle = nullptr;
+}
+
+TaskRoutine& TaskRoutine::operator=(TaskRoutine&& other) noexcept
+{
+    if (_handle)
+        _handle.destroy();
+    _handle = other._handle;
+    other._handle = nullptr;
+    return *this;
+}
+
+TaskRoutine::~TaskRoutine()
+{
+    if (_handle)
+        _handle.destroy();
+}
+
+void DelayAwaiter::await_suspend(TaskRoutine::Handle h) const noexcept
+{
+    h.promise().task->sleep(delayMs);
+}
+
+CoroutineTask::CoroutineTask(TaskRoutine&& routine, EndCallback cb) :
+    Task(std::move(cb)),
+    _routine(std::move(routine))
+{
+    if (_routine)
+        _routine._handle.promise().task = this;
+}
+
+void CoroutineTask::onBegin()
+{
+    //  the routine's frame could not be allocated
+    if (!_routine)
+        fail();
+}
+
+void CoroutineTask::onUpdate(uint32_t)
+{
+    auto& promise = _routine._handle.promise();
+    if (promise.waitPoll)
+    {
+        if (!promise.waitPoll(promise.waiter))
+            return;
+        promise.waitPoll = nullptr;
+        promise.waiter = nullptr;
+    }
+
+    _routine._handle.resume();
+
+    if (_routine._handle.done())
+        end();
+}
+
+} /* namespace cinek */
+
+#endif
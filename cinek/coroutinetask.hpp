@@ -0,0 +1,267 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/coroutinetask.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Tasks implemented as C++20 coroutines
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_COROUTINE_TASK_HPP
+#define CINEK_COROUTINE_TASK_HPP
+
+#include "cinek/taskscheduler.hpp"
+#include "ckio/file.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+
+namespace cinek {
+
+    class CoroutineTask;
+
+    /**
+     *  @class  TaskRoutine
+     *  @brief  The return type of a coroutine run by a CoroutineTask
+     *
+     *  A routine's first parameter must be the TaskScheduler running it,
+     *  followed by at most seven other parameters.  The routine's frame is
+     *  allocated from the scheduler's task allocator, and the scheduler is
+     *  used to resolve TaskIds awaited by the routine.
+     *
+     *  Within a routine, the following may be awaited:
+     *  - nextFrame(), resuming on the next scheduler update
+     *  - delay(ms), resuming once the delay has elapsed
+     *  - A TaskId, resuming once the task is no longer active
+     *  - A ckio_handle*, resuming once its pending request completes.  The
+     *    co_await expression yields the request's ckio_status.
+     */
+    class TaskRoutine
+    {
+        CK_CLASS_NON_COPYABLE(TaskRoutine);
+
+    public:
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        /** Awaiter for a TaskId */
+        struct TaskAwaiter
+        {
+            TaskScheduler* scheduler;
+            TaskId taskId;
+
+            bool await_ready() const noexcept { return !scheduler->isActive(taskId); }
+            void await_suspend(Handle h) noexcept;
+            void await_resume() const noexcept {}
+        };
+
+        /**
+         *  Awaiter for a pending ckio request.  Defined inline so that ckio
+         *  is only required by applications awaiting requests.
+         */
+        struct IOAwaiter
+        {
+            ckio_handle* handle;
+            ckio_status status;
+
+            bool await_ready() noexcept { return poll(this); }
+            inline void await_suspend(Handle h) noexcept;
+            ckio_status await_resume() const noexcept { return status; }
+
+            static bool poll(void* awaiter)
+            {
+                auto self = reinterpret_cast<IOAwaiter*>(awaiter);
+                self->status = ckio_get_status(self->handle, nullptr);
+                return self->status != kCKIO_Pending;
+            }
+        };
+
+        struct promise_type
+        {
+            template<typename... Args>
+            promise_type(TaskScheduler& scheduler, Args&...) noexcept :
+                scheduler(&scheduler),
+                task(nullptr),
+                waitPoll(nullptr),
+                waiter(nullptr)
+            {
+            }
+
+            //  the frame's operator new is not a template, so that GCC pairs
+            //  it with the operator delete below.  Arguments following the
+            //  scheduler are accepted and ignored through FrameArg.
+            struct FrameArg
+            {
+                FrameArg() noexcept = default;
+                template<typename T> FrameArg(const T&) noexcept {}
+            };
+            static void* operator new(size_t size, TaskScheduler& scheduler,
+                                      FrameArg=FrameArg(), FrameArg=FrameArg(),
+                                      FrameArg=FrameArg(), FrameArg=FrameArg(),
+                                      FrameArg=FrameArg(), FrameArg=FrameArg(),
+                                      FrameArg=FrameArg()) noexcept
+            {
+                return allocFrame(scheduler.taskAllocator(), size);
+            }
+            static void operator delete(void* ptr, size_t) noexcept
+            {
+                freeFrame(ptr);
+            }
+            static TaskRoutine get_return_object_on_allocation_failure() noexcept
+            {
+                return TaskRoutine();
+            }
+
+            TaskRoutine get_return_object() noexcept
+            {
+                return TaskRoutine(Handle::from_promise(*this));
+            }
+            //  routines start on their task's first update
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            //  the frame is destroyed by its TaskRoutine
+            std::suspend_always final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept;
+
+            template<typename Awaitable>
+            Awaitable await_transform(Awaitable awaitable) const noexcept
+            {
+                return awaitable;
+            }
+            TaskAwaiter await_transform(TaskId taskId) const noexcept
+            {
+                return TaskAwaiter { scheduler, taskId };
+            }
+            IOAwaiter await_transform(ckio_handle* handle) const noexcept
+            {
+                return IOAwaiter { handle, kCKIO_Pending };
+            }
+
+            TaskScheduler* scheduler;
+            CoroutineTask* task;
+            //  polled by the task before resuming a routine suspended on a
+            //  condition, with the awaiter owning the condition
+            bool (*waitPoll)(void* awaiter);
+            void* waiter;
+
+        private:
+            static void* allocFrame(Allocator allocator, size_t size) noexcept;
+            static void freeFrame(void* ptr) noexcept;
+        };
+
+        TaskRoutine() = default;
+        TaskRoutine(TaskRoutine&& other) noexcept;
+        TaskRoutine& operator=(TaskRoutine&& other) noexcept;
+        ~TaskRoutine();
+
+        /** @return True if the routine has a frame */
+        explicit operator bool() const { return (bool)_handle; }
+
+    private:
+        friend class CoroutineTask;
+        explicit TaskRoutine(Handle handle) : _handle(handle) {}
+
+        Handle _handle;
+    };
+
+    inline void TaskRoutine::IOAwaiter::await_suspend(Handle h) noexcept
+    {
+        auto& promise = h.promise();
+        promise.waitPoll = &IOAwaiter::poll;
+        promise.waiter = this;
+    }
+
+    /** Awaiter resuming a routine on the next scheduler update */
+    struct NextFrameAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        void await_resume() const noexcept {}
+    };
+
+    /** Awaiter resuming a routine after a delay */
+    struct DelayAwaiter
+    {
+        uint32_t delayMs;
+
+        bool await_ready() const noexcept { return !delayMs; }
+        void await_suspend(TaskRoutine::Handle h) const noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    /** @return An awaitable resuming the routine on the next update */
+    inline NextFrameAwaiter nextFrame() { return NextFrameAwaiter(); }
+    /**
+     *  @param  delayMs The delay in milliseconds
+     *  @return An awaitable resuming the routine after the delay
+     */
+    inline DelayAwaiter delay(uint32_t delayMs) { return DelayAwaiter { delayMs }; }
+
+    /**
+     *  @class  CoroutineTask
+     *  @brief  A Task that runs a TaskRoutine, ending when the routine returns
+     *
+     *  Multi-step tasks written as a routine need only the task and the
+     *  routine's frame, both of which may come from the scheduler's task
+     *  pool:
+     *
+     *  @code
+     *  TaskRoutine spawnWave(TaskScheduler& scheduler, Wave* wave)
+     *  {
+     *      co_await delay(wave->warmupMs);
+     *      TaskId spawnerId = scheduler.schedule(...);
+     *      co_await spawnerId;
+     *      co_await nextFrame();
+     *      ...
+     *  }
+     *
+     *  scheduler.schedule(scheduler.createTask<CoroutineTask>(
+     *      spawnWave(scheduler, wave)));
+     *  @endcode
+     */
+    class CoroutineTask : public Task
+    {
+    public:
+        /**
+         *  @param  routine The routine to run
+         *  @param  cb      The callback executed upon an end or fail result
+         */
+        CoroutineTask(TaskRoutine&& routine, EndCallback cb=nullptr);
+
+    protected:
+        void onBegin() override;
+        void onUpdate(uint32_t deltaTimeMs) override;
+
+    private:
+        friend struct DelayAwaiter;
+
+        TaskRoutine _routine;
+    };
+
+} /* namespace cinek */
+
+#endif
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/delegate.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A fixed-size callable wrapper that never allocates
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_DELEGATE_HPP
+#define CINEK_DELEGATE_HPP
+
+#include "cinek/types.hpp"
+#include "cinek/debug.h"
+
+#include <new>
+
+namespace cinek {
+
+    template<typename Signature, size_t Size=4*sizeof(void*)> class Delegate;
+
+    /**
+     * @class Delegate
+     * @brief A std::function like wrapper storing its callable inline.
+     *
+     * Callables must fit within Size bytes, which is checked at compile time.
+     * Unlike std::function there is no fallback to heap allocation.
+     */
+    template<typename R, typename... Args, size_t Size>
+    class Delegate<R(Args...), Size>
+    {
+        template<typename Fn> using EnableIfCallable =
+            typename std::enable_if<
+                !std::is_same<typename std::decay<Fn>::type, Delegate>::value &&
+                std::is_convertible<
+                    decltype(std::declval<typename std::decay<Fn>::type&>()(
+                        std::declval<Args>()...)),
+                    R>::value
+            >::type;
+
+    public:
+        Delegate() noexcept : _invoke(nullptr), _manage(nullptr) {}
+        Delegate(std::nullptr_t) noexcept : _invoke(nullptr), _manage(nullptr) {}
+
+        template<typename Fn, typename=EnableIfCallable<Fn>>
+        Delegate(Fn&& fn);
+
+        Delegate(const Delegate& other);
+        Delegate(Delegate&& other) noexcept;
+        ~Delegate();
+
+        Delegate& operator=(const Delegate& other);
+        Delegate& operator=(Delegate&& other) noexcept;
+        Delegate& operator=(std::nullptr_t) noexcept;
+
+        explicit operator bool() const { return _invoke != nullptr; }
+
+        R operator()(Args... args) const;
+
+    private:
+        enum class Op { kCopy, kMove, kDestroy };
+
+        using Invoker = R (*)(void* storage, Args&&... args);
+        using Manager = void (*)(Op op, void* dest, void* src);
+
+        template<typename Fn> static R invoke(void* storage, Args&&... args);
+        template<typename Fn> static void manage(Op op, void* dest, void* src);
+
+        template<typename Fn> static bool isNull(const Fn&) { return false; }
+        template<typename Ret, typename... Params>
+        static bool isNull(Ret (*fn)(Params...)) { return fn == nullptr; }
+
+        void reset();
+
+        alignas(std::max_align_t) mutable unsigned char _storage[Size];
+        Invoker _invoke;
+        Manager _manage;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    template<typename R, typename... Args, size_t Size>
+    template<typename Fn, typename>
+    Delegate<R(Args...), Size>::Delegate(Fn&& fn) :
+        _invoke(nullptr),
+        _manage(nullptr)
+    {
+        using Callable = typename std::decay<Fn>::type;
+        static_assert(sizeof(Callable) <= Size,
+                      "Callable is too large for this Delegate");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t),
+                      "Callable is overaligned for this Delegate");
+
+        if (isNull(fn))
+            return;
+
+        ::new(_storage) Callable(std::forward<Fn>(fn));
+        _invoke = &invoke<Callable>;
+        _manage = &manage<Callable>;
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    Delegate<R(Args...), Size>::Delegate(const Delegate& other) :
+        _invoke(other._invoke),
+        _manage(other._manage)
+    {
+        if (_manage)
+            _manage(Op::kCopy, _storage, other._storage);
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    Delegate<R(Args...), Size>::Delegate(Delegate&& other) noexcept :
+        _invoke(other._invoke),
+        _manage(other._manage)
+    {
+        if (_manage)
+        {
+            _manage(Op::kMove, _storage, other._storage);
+            other.reset();
+        }
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    Delegate<R(Args...), Size>::~Delegate()
+    {
+        reset();
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    auto Delegate<R(Args...), Size>::operator=(const Delegate& other) -> Delegate&
+    {
+        if (&other != this)
+        {
+            reset();
+            if (other._manage)
+                other._manage(Op::kCopy, _storage, other._storage);
+            _invoke = other._invoke;
+            _manage = other._manage;
+        }
+        return *this;
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    auto Delegate<R(Args...), Size>::operator=(Delegate&& other) noexcept -> Delegate&
+    {
+        if (&other != this)
+        {
+            reset();
+            if (other._manage)
+                other._manage(Op::kMove, _storage, other._storage);
+            _invoke = other._invoke;
+            _manage = other._manage;
+            other.reset();
+        }
+        return *this;
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    auto Delegate<R(Args...), Size>::operator=(std::nullptr_t) noexcept -> Delegate&
+    {
+        reset();
+        return *this;
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    R Delegate<R(Args...), Size>::operator()(Args... args) const
+    {
+        CK_ASSERT(_invoke);
+        return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    void Delegate<R(Args...), Size>::reset()
+    {
+        if (_manage)
+            _manage(Op::kDestroy, _storage, nullptr);
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    template<typename Fn>
+    R Delegate<R(Args...), Size>::invoke(void* storage, Args&&... args)
+    {
+        return (*reinterpret_cast<Fn*>(storage))(std::forward<Args>(args)...);
+    }
+
+    template<typename R, typename... Args, size_t Size>
+    template<typename Fn>
+    void Delegate<R(Args...), Size>::manage(Op op, void* dest, void* src)
+    {
+        switch (op)
+        {
+        case Op::kCopy:
+            ::new(dest) Fn(*reinterpret_cast<const Fn*>(src));
+            break;
+        case Op::kMove:
+            ::new(dest) Fn(std::move(*reinterpret_cast<Fn*>(src)));
+            break;
+        case Op::kDestroy:
+            reinterpret_cast<Fn*>(dest)->~Fn();
+            break;
+        }
+    }
+
+} /* namespace cinek */
+
+#endif
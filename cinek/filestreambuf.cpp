@@ -9,6 +9,7 @@
  */
 
 #include "filestreambuf.hpp"
+#include <cstring>
 
 
 namespace cinek {
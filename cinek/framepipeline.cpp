@@ -0,0 +1,205 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/framepipeline.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Overlaps frame stages across a JobSystem
+ * @copyright Cinekine
+ */
+
+#include "cinek/framepipeline.hpp"
+#include "cinek/jobsystem.hpp"
+#include "cinek/debug.h"
+
+#include <chrono>
+#include <thread>
+
+namespace cinek {
+
+namespace {
+
+    uint64_t nowUs()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+}
+
+FramePipeline::FramePipeline
+(
+    JobSystem& jobSystem,
+    const InitParams& params,
+    const Allocator& allocator
+) :
+    _jobSystem(jobSystem),
+    _inFlightLimit(params.inFlightLimit ? params.inFlightLimit : 1),
+    _stages(allocator),
+    _slotStartUs(_inFlightLimit, 0, allocator),
+    _submitted(0),
+    _completed(0),
+    _frameStats()
+{
+    _stages.reserve(params.stageLimit);
+}
+
+FramePipeline::~FramePipeline()
+{
+    flush();
+    //  the job finishing the last frame may still hold the lock
+    std::lock_guard<std::mutex> lock(_mutex);
+}
+
+uint32_t FramePipeline::addStage(const char* name, StageFn fn)
+{
+    CK_ASSERT_RETURN_VALUE(!_submitted, (uint32_t)-1);
+
+    Stage stage;
+    stage.name = name;
+    stage.fn = std::move(fn);
+    stage.completed = 0;
+    stage.stats = Stats();
+    _stages.push_back(std::move(stage));
+    return (uint32_t)_stages.size() - 1;
+}
+
+const char* FramePipeline::stageName(uint32_t stage) const
+{
+    CK_ASSERT_RETURN_VALUE(stage < _stages.size(), "");
+    return _stages[stage].name;
+}
+
+uint32_t FramePipeline::completedFrameCount() const
+{
+    return _completed.load(std::memory_order_acquire);
+}
+
+auto FramePipeline::stageStats(uint32_t stage) const -> Stats
+{
+    CK_ASSERT_RETURN_VALUE(stage < _stages.size(), Stats());
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stages[stage].stats;
+}
+
+auto FramePipeline::frameStats() const -> Stats
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _frameStats;
+}
+
+uint32_t FramePipeline::submit()
+{
+    CK_ASSERT_RETURN_VALUE(!_stages.empty(), (uint32_t)-1);
+
+    const uint32_t frame = _submitted;
+    if (frame >= _inFlightLimit)
+        wait(frame - _inFlightLimit);
+
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slotStartUs[slot(frame)] = nowUs();
+        _submitted = frame + 1;
+        ready = _stages[0].completed == frame;
+    }
+    if (ready)
+        launch(frame, 0);
+    return frame;
+}
+
+void FramePipeline::wait(uint32_t frame)
+{
+    CK_ASSERT_RETURN(frame < _submitted);
+
+    while (_completed.load(std::memory_order_acquire) <= frame)
+    {
+        if (!_jobSystem.pump())
+            std::this_thread::yield();
+    }
+}
+
+void FramePipeline::flush()
+{
+    if (_submitted)
+        wait(_submitted - 1);
+}
+
+void FramePipeline::launch(uint32_t frame, uint32_t stage)
+{
+    FramePipeline* self = this;
+    _jobSystem.run([self, frame, stage]() {
+        self->runStage(frame, stage);
+    }, nullptr);
+}
+
+void FramePipeline::runStage(uint32_t frame, uint32_t stage)
+{
+    const uint64_t startUs = nowUs();
+    _stages[stage].fn(frame, slot(frame));
+    const uint64_t endUs = nowUs();
+
+    //  stage S of frame F waits on stage S-1 of frame F and on stage S of
+    //  frame F-1.  whichever of the two finishes last launches it.
+    bool launchNextStage = false;
+    bool launchNextFrame = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stage& current = _stages[stage];
+        current.completed = frame + 1;
+        record(current.stats, endUs - startUs);
+
+        if (stage + 1 < _stages.size())
+        {
+            launchNextStage = _stages[stage+1].completed == frame;
+        }
+        else
+        {
+            record(_frameStats, endUs - _slotStartUs[slot(frame)]);
+            _completed.store(frame + 1, std::memory_order_release);
+        }
+        if (frame + 1 < _submitted)
+        {
+            launchNextFrame = stage == 0 ||
+                              _stages[stage-1].completed > frame + 1;
+        }
+    }
+    //  launching outside the lock, as a full job pool runs the stage
+    //  inline.  a launch implies an unfinished frame, so the pipeline
+    //  can't have been destroyed yet.
+    if (launchNextStage)
+        launch(frame, stage + 1);
+    if (launchNextFrame)
+        launch(frame + 1, stage);
+}
+
+void FramePipeline::record(Stats& stats, uint64_t us)
+{
+    ++stats.frameCount;
+    stats.lastUs = (uint32_t)us;
+    if (stats.lastUs > stats.maxUs)
+        stats.maxUs = stats.lastUs;
+    stats.totalUs += us;
+}
+
+} /* namespace cinek */
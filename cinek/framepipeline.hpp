@@ -0,0 +1,189 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/framepipeline.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Overlaps frame stages across a JobSystem
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_FRAME_PIPELINE_HPP
+#define CINEK_FRAME_PIPELINE_HPP
+
+#include "cinek/delegate.hpp"
+#include "cinek/vector.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace cinek {
+
+    class JobSystem;
+
+    /**
+     *  @class  FramePipeline
+     *  @brief  Runs a frame's stages as a pipeline of overlapping frames
+     *
+     *  A frame is a fixed sequence of stages (i.e. simulate, cull, build
+     *  render data.)  Within a frame the stages run in order, and each stage
+     *  processes frames in order, but different stages may work on different
+     *  frames at once - frame N+1 can simulate while frame N is culled.
+     *  Stages run as jobs on a JobSystem.
+     *
+     *  At most inFlightLimit frames run at once.  Each in-flight frame owns
+     *  a slot in [0, inFlightLimit), passed to its stages, so data handed
+     *  from one stage to the next can be buffered per slot (see
+     *  PipelineBuffer) without locking.  A limit of one runs frames
+     *  serially.
+     *
+     *  The pipeline records the execution time of each stage and the
+     *  latency of each frame, from submit() to the end of its last stage.
+     */
+    class FramePipeline
+    {
+        CK_CLASS_NON_COPYABLE(FramePipeline);
+
+    public:
+        /** A stage entry point, invoked with the frame index and its slot */
+        using StageFn = Delegate<void(uint32_t frame, uint32_t slot)>;
+
+        struct InitParams
+        {
+            /** Maximum number of frames in flight */
+            uint32_t inFlightLimit;
+            /** Number of stages to reserve */
+            uint32_t stageLimit;
+        };
+
+        /** Timings of a stage, or of whole frames */
+        struct Stats
+        {
+            uint32_t frameCount;
+            uint32_t lastUs;
+            uint32_t maxUs;
+            uint64_t totalUs;
+        };
+
+        FramePipeline(JobSystem& jobSystem, const InitParams& params,
+                      const Allocator& allocator=Allocator());
+        /** Waits for all in-flight frames to finish */
+        ~FramePipeline();
+
+        /**
+         * Appends a stage to each frame.  Stages must be added before the
+         * first frame is submitted.
+         *
+         * @param  name The stage's name, for diagnostics
+         * @param  fn   The stage entry point.  Runs on a job system worker.
+         * @return The stage index
+         */
+        uint32_t addStage(const char* name, StageFn fn);
+        /**
+         * Starts the next frame.  If inFlightLimit frames are already
+         * running, waits for the oldest to finish first, executing jobs
+         * while waiting.
+         *
+         * @return The submitted frame's index
+         */
+        uint32_t submit();
+        /**
+         * Waits until the given frame has finished all of its stages,
+         * executing jobs while waiting.
+         *
+         * @param frame The frame index returned by submit()
+         */
+        void wait(uint32_t frame);
+        /** Waits until every submitted frame has finished */
+        void flush();
+
+        /** @return Maximum number of in-flight frames (and slots) */
+        uint32_t inFlightLimit() const { return _inFlightLimit; }
+        /** @return The slot used by a frame */
+        uint32_t slot(uint32_t frame) const { return frame % _inFlightLimit; }
+        /** @return Number of stages per frame */
+        uint32_t stageCount() const { return (uint32_t)_stages.size(); }
+        /** @return The name of a stage */
+        const char* stageName(uint32_t stage) const;
+        /** @return Number of frames submitted */
+        uint32_t submittedFrameCount() const { return _submitted; }
+        /** @return Number of frames that finished all stages */
+        uint32_t completedFrameCount() const;
+        /** @return Execution times of a stage */
+        Stats stageStats(uint32_t stage) const;
+        /** @return Latencies of whole frames, from submit to completion */
+        Stats frameStats() const;
+
+    private:
+        struct Stage
+        {
+            const char* name;
+            StageFn fn;
+            uint32_t completed;     // frames that finished this stage
+            Stats stats;
+        };
+
+        void launch(uint32_t frame, uint32_t stage);
+        void runStage(uint32_t frame, uint32_t stage);
+        static void record(Stats& stats, uint64_t us);
+
+        JobSystem& _jobSystem;
+        uint32_t _inFlightLimit;
+
+        mutable std::mutex _mutex;
+        vector<Stage> _stages;
+        vector<uint64_t> _slotStartUs;
+        uint32_t _submitted;
+        std::atomic<uint32_t> _completed;
+        Stats _frameStats;
+    };
+
+    /**
+     *  @class  PipelineBuffer
+     *  @brief  Per-slot storage for data passed between pipeline stages
+     *
+     *  Holds one T per FramePipeline slot.  A stage writes at(slot) and a
+     *  later stage of the same frame reads it, while other stages work on
+     *  the other slots.  With an in-flight limit of two, this is a double
+     *  buffer.
+     */
+    template<typename T>
+    class PipelineBuffer
+    {
+    public:
+        PipelineBuffer(const FramePipeline& pipeline,
+                       const Allocator& allocator=Allocator()) :
+            _items(pipeline.inFlightLimit(), T(), allocator)
+        {
+        }
+
+        T& at(uint32_t slot) { return _items[slot]; }
+        const T& at(uint32_t slot) const { return _items[slot]; }
+
+    private:
+        vector<T> _items;
+    };
+
+} /* namespace cinek */
+
+#endif
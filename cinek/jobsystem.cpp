@@ -0,0 +1,706 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/jobsystem.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A work-stealing multithreaded job system
+ * @copyright Cinekine
+ */
+
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+//  required for the deprecated, but functional, ucontext API
+#define _XOPEN_SOURCE 600
+#endif
+
+#include "cinek/jobsystem.hpp"
+#include "cinek/workstealing_queue.hpp"
+#include "cinek/debug.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CINEK_JOB_FIBERS 1
+#include <ucontext.h>
+#else
+#define CINEK_JOB_FIBERS 0
+#endif
+
+namespace cinek {
+
+namespace {
+    //  number of failed attempts at finding work before a worker sleeps
+    const uint32_t kIdleSpinLimit = 64;
+    //  upper bound on a sleeping worker's wait, in case of a missed wakeup
+    const std::chrono::milliseconds kIdleSleepTime(2);
+}
+
+struct JobSystem::Worker
+{
+    WorkStealingQueue<Job*, kWorkerQueueSize> queue;
+    std::thread thread;
+    JobSystem* owner;
+    uint32_t index;
+    uint32_t rngState;
+
+    uint32_t nextRandom() {
+        //  xorshift32
+        uint32_t x = rngState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        rngState = x;
+        return x;
+    }
+};
+
+struct JobSystem::Fiber
+{
+    enum State
+    {
+        kRunning,
+        kWaiting,
+        kFinished
+    };
+
+#if CINEK_JOB_FIBERS
+    ucontext_t context;
+    //  the context of the worker that last resumed the fiber
+    ucontext_t* returnContext;
+#endif
+    JobSystem* owner;
+    uint8_t* stack;
+    JobFunction fn;
+    void* data;
+    JobCounter* counter;
+    const JobCounter* waitCounter;
+    State state;
+    alignas(void*) uint8_t payload[kJobPayloadSize];
+};
+
+thread_local JobSystem::Worker* JobSystem::_tlsWorker = nullptr;
+thread_local JobSystem::Fiber* JobSystem::_tlsFiber = nullptr;
+
+JobSystem::JobSystem(const InitParams& params, const Allocator& allocator) :
+    _allocator(allocator),
+    _workers(allocator),
+    _jobs(nullptr),
+    _jobLimit(params.jobLimit),
+    _freeJobHead(0),
+    _injected(allocator),
+    _injectedCount(0),
+    _sleeperCount(0),
+    _running(true),
+    _fibers(nullptr),
+    _fiberStacks(nullptr),
+    _fiberLimit(CINEK_JOB_FIBERS ? params.fiberLimit : 0),
+    _fiberStackSize((params.fiberStackSize + 15) & ~15U),
+    _freeFibers(allocator),
+    _waitingFibers(allocator),
+    _waitingFiberCount(0)
+{
+    uint32_t workerCount = params.workerCount;
+    if (!workerCount)
+    {
+        workerCount = std::thread::hardware_concurrency();
+        if (!workerCount)
+            workerCount = 1;
+    }
+
+    //  build the job record free list
+    if (_jobLimit)
+    {
+        _jobs = reinterpret_cast<Job*>(
+            _allocator.allocAligned(sizeof(Job) * _jobLimit, alignof(Job)));
+        for (uint32_t i = 0; i < _jobLimit; ++i)
+        {
+            ::new(&_jobs[i]) Job();
+            _jobs[i].nextFree.store(i+1 < _jobLimit ? i+2 : 0,
+                                    std::memory_order_relaxed);
+        }
+        _freeJobHead.store(1, std::memory_order_relaxed);
+    }
+    _injected.reserve(_jobLimit);
+
+    //  fiber stacks are carved from a single block
+    if (_fiberLimit)
+    {
+        _fibers = reinterpret_cast<Fiber*>(
+            _allocator.allocAligned(sizeof(Fiber) * _fiberLimit, alignof(Fiber)));
+        _fiberStacks = reinterpret_cast<uint8_t*>(
+            _allocator.allocAligned((size_t)_fiberStackSize * _fiberLimit, 16));
+        _freeFibers.reserve(_fiberLimit);
+        _waitingFibers.reserve(_fiberLimit);
+        for (uint32_t i = 0; i < _fiberLimit; ++i)
+        {
+            Fiber* fiber = ::new(&_fibers[i]) Fiber();
+            fiber->owner = this;
+            fiber->stack = _fiberStacks + (size_t)_fiberStackSize * i;
+            _freeFibers.push_back(fiber);
+        }
+    }
+
+    _workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        Worker* worker = reinterpret_cast<Worker*>(
+            _allocator.allocAligned(sizeof(Worker), alignof(Worker)));
+        ::new(worker) Worker();
+        worker->owner = this;
+        worker->index = i;
+        worker->rngState = 0x9e3779b9u * (i+1);
+        _workers.push_back(worker);
+    }
+
+    //  the creating thread is worker zero.  launch threads only after all
+    //  workers exist, since threads steal from every worker
+    _tlsWorker = _workers[0];
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        Worker* worker = _workers[i];
+        worker->thread = std::thread(&JobSystem::workerMain, this, worker);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _running.store(false, std::memory_order_release);
+    }
+    _wakeCondition.notify_all();
+
+    for (auto worker : _workers)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+
+    //  drain jobs left behind by the workers, since counters and job data
+    //  may be owned by objects expecting completion.
+    Worker* self = currentWorker();
+    for (;;)
+    {
+        if (resumeReadyFiber())
+            continue;
+        Job* job = findJob(self);
+        if (!job)
+            break;
+        execute(job);
+    }
+    CK_ASSERT(_waitingFibers.empty());
+
+    if (_tlsWorker && _tlsWorker->owner == this)
+        _tlsWorker = nullptr;
+
+    for (auto worker : _workers)
+    {
+        worker->~Worker();
+        _allocator.freeAligned(worker);
+    }
+    _workers.clear();
+
+    _allocator.freeAligned(_jobs);
+    _jobs = nullptr;
+
+    if (_fibers)
+    {
+        for (uint32_t i = 0; i < _fiberLimit; ++i)
+        {
+            _fibers[i].~Fiber();
+        }
+        _allocator.freeAligned(_fibers);
+        _allocator.freeAligned(_fiberStacks);
+        _fibers = nullptr;
+        _fiberStacks = nullptr;
+    }
+}
+
+auto JobSystem::currentWorker() const -> Worker*
+{
+    Worker* worker = _tlsWorker;
+    return (worker && worker->owner == this) ? worker : nullptr;
+}
+
+int32_t JobSystem::currentWorkerIndex() const
+{
+    Worker* worker = currentWorker();
+    return worker ? (int32_t)worker->index : -1;
+}
+
+auto JobSystem::allocJob() -> Job*
+{
+    uint64_t head = _freeJobHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t index = (uint32_t)head;
+        if (!index)
+            return nullptr;
+        Job* job = &_jobs[index-1];
+        uint64_t next = job->nextFree.load(std::memory_order_relaxed);
+        //  the tag in the upper 32-bits prevents ABA on the head
+        uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+        if (_freeJobHead.compare_exchange_weak(head, newHead,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire))
+        {
+            return job;
+        }
+    }
+}
+
+void JobSystem::freeJob(Job* job)
+{
+    uint32_t index = (uint32_t)(job - _jobs) + 1;
+    uint64_t head = _freeJobHead.load(std::memory_order_relaxed);
+    uint64_t newHead;
+    do
+    {
+        job->nextFree.store((uint32_t)head, std::memory_order_relaxed);
+        newHead = (((head >> 32) + 1) << 32) | index;
+    }
+    while (!_freeJobHead.compare_exchange_weak(head, newHead,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void JobSystem::run(const JobDecl* decls, uint32_t count, JobCounter* counter)
+{
+    if (counter)
+        counter->_value.fetch_add((int32_t)count, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Job* job = allocJob();
+        if (!job)
+        {
+            //  out of job records - execute the job on this thread
+            decls[i].fn(decls[i].data);
+            if (counter)
+                signalCounter(counter);
+            continue;
+        }
+        job->fn = decls[i].fn;
+        job->data = decls[i].data;
+        job->counter = counter;
+        submit(job);
+    }
+}
+
+void JobSystem::submit(Job* job)
+{
+    Worker* worker = currentWorker();
+    if (worker)
+    {
+        if (!worker->queue.push(job))
+        {
+            //  our deque is full, so run the job now instead of blocking
+            execute(job);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_injectMutex);
+        _injected.push_back(job);
+        _injectedCount.fetch_add(1, std::memory_order_release);
+    }
+
+    wakeWorker();
+}
+
+void JobSystem::wakeWorker()
+{
+    if (_sleeperCount.load() > 0)
+    {
+        //  acquiring the lock guarantees a sleeper is either waiting on the
+        //  condition or hasn't yet evaluated its wake predicate
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _wakeCondition.notify_one();
+    }
+}
+
+void JobSystem::signalCounter(JobCounter* counter)
+{
+    //  a fiber waiting on the counter is only resumed by a worker polling
+    //  for ready fibers, which may all be asleep.  The counter may be torn
+    //  down by its waiter once it reaches zero, so it isn't touched after
+    //  the decrement.
+    if (counter->_value.fetch_sub(1) == 1 && _waitingFiberCount.load() > 0)
+        wakeWorker();
+}
+
+auto JobSystem::findJob(Worker* worker) -> Job*
+{
+    Job* job = nullptr;
+    if (worker && worker->queue.pop(job))
+        return job;
+
+    if (_injectedCount.load(std::memory_order_acquire) > 0)
+    {
+        std::lock_guard<std::mutex> lock(_injectMutex);
+        if (!_injected.empty())
+        {
+            job = _injected.back();
+            _injected.pop_back();
+            _injectedCount.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    const uint32_t count = (uint32_t)_workers.size();
+    const uint32_t start = worker ? worker->nextRandom() % count : 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Worker* victim = _workers[(start + i) % count];
+        if (victim == worker)
+            continue;
+        if (victim->queue.steal(job))
+            return job;
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    job->fn(job->data);
+
+    //  free the record before signaling, since a waiter may tear down the
+    //  counter as soon as it reaches zero
+    JobCounter* counter = job->counter;
+    freeJob(job);
+    if (counter)
+        signalCounter(counter);
+}
+
+bool JobSystem::hasPendingJobs()
+{
+    if (_injectedCount.load(std::memory_order_relaxed) > 0)
+        return true;
+    if (hasReadyFibers())
+        return true;
+    for (auto worker : _workers)
+    {
+        if (worker->queue.sizeHint() > 0)
+            return true;
+    }
+    return false;
+}
+
+void JobSystem::workerMain(Worker* worker)
+{
+    _tlsWorker = worker;
+
+    uint32_t idleCount = 0;
+    while (_running.load(std::memory_order_acquire))
+    {
+        if (resumeReadyFiber())
+        {
+            idleCount = 0;
+            continue;
+        }
+        Job* job = findJob(worker);
+        if (job)
+        {
+            execute(job);
+            idleCount = 0;
+            continue;
+        }
+        if (++idleCount < kIdleSpinLimit)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleeperCount.fetch_add(1, std::memory_order_acq_rel);
+        _wakeCondition.wait_for(lock, kIdleSleepTime, [this]() {
+            return !_running.load(std::memory_order_acquire) || hasPendingJobs();
+        });
+        _sleeperCount.fetch_sub(1, std::memory_order_acq_rel);
+        idleCount = 0;
+    }
+
+    _tlsWorker = nullptr;
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+#if CINEK_JOB_FIBERS
+    Fiber* fiber = _tlsFiber;
+    if (fiber && fiber->owner == this)
+    {
+        //  the fiber may resume on another worker, so thread locals must not
+        //  be referenced beyond this point
+        while (!counter.done())
+        {
+            fiber->waitCounter = &counter;
+            fiber->state = Fiber::kWaiting;
+            swapcontext(&fiber->context, fiber->returnContext);
+        }
+        return;
+    }
+#endif
+
+    Worker* worker = currentWorker();
+    while (!counter.done())
+    {
+        if (resumeReadyFiber())
+            continue;
+        Job* job = findJob(worker);
+        if (job)
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+bool JobSystem::pump()
+{
+    if (resumeReadyFiber())
+        return true;
+    Job* job = findJob(currentWorker());
+    if (!job)
+        return false;
+    execute(job);
+    return true;
+}
+
+void JobSystem::runFiber
+(
+    const JobDecl* decls,
+    uint32_t count,
+    JobCounter* counter
+)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Fiber* fiber = allocFiber();
+        if (!fiber)
+        {
+            run(&decls[i], 1, counter);
+            continue;
+        }
+        if (counter)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        launchFiber(fiber, decls[i].fn, decls[i].data, counter);
+    }
+}
+
+auto JobSystem::allocFiber() -> Fiber*
+{
+    if (!_fiberLimit)
+        return nullptr;
+    std::lock_guard<std::mutex> lock(_fiberMutex);
+    if (_freeFibers.empty())
+        return nullptr;
+    Fiber* fiber = _freeFibers.back();
+    _freeFibers.pop_back();
+    return fiber;
+}
+
+void JobSystem::freeFiber(Fiber* fiber)
+{
+    std::lock_guard<std::mutex> lock(_fiberMutex);
+    _freeFibers.push_back(fiber);
+}
+
+void* JobSystem::fiberPayload(Fiber* fiber)
+{
+    return fiber->payload;
+}
+
+//  makecontext only passes int arguments, so the fiber pointer is split
+void JobSystem::fiberEntry(unsigned int lo, unsigned int hi)
+{
+    uintptr_t address = ((uintptr_t)hi << 16 << 16) | lo;
+    startFiber(reinterpret_cast<void*>(address));
+}
+
+void JobSystem::launchFiber
+(
+    Fiber* fiber,
+    JobFunction fn,
+    void* data,
+    JobCounter* counter
+)
+{
+    fiber->fn = fn;
+    fiber->data = data;
+    fiber->counter = counter;
+    fiber->waitCounter = nullptr;
+    fiber->state = Fiber::kRunning;
+
+#if CINEK_JOB_FIBERS
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = fiber->stack;
+    fiber->context.uc_stack.ss_size = _fiberStackSize;
+    fiber->context.uc_link = nullptr;
+    uintptr_t address = reinterpret_cast<uintptr_t>(fiber);
+    makecontext(&fiber->context, (void (*)())&fiberEntry, 2,
+                (unsigned int)address, (unsigned int)(address >> 16 >> 16));
+#endif
+
+    //  the fiber's first resume is itself a job, so that it's distributed
+    //  across workers like any other
+    Job* job = allocJob();
+    if (!job)
+    {
+        resumeFiber(fiber);
+        return;
+    }
+    job->fn = [](void* data) {
+        Fiber* fiber = reinterpret_cast<Fiber*>(data);
+        fiber->owner->resumeFiber(fiber);
+    };
+    job->data = fiber;
+    job->counter = nullptr;
+    submit(job);
+}
+
+void JobSystem::startFiber(void* data)
+{
+    Fiber* fiber = reinterpret_cast<Fiber*>(data);
+    fiber->fn(fiber->data);
+    fiber->state = Fiber::kFinished;
+#if CINEK_JOB_FIBERS
+    setcontext(fiber->returnContext);
+#endif
+}
+
+void JobSystem::resumeFiber(Fiber* fiber)
+{
+#if CINEK_JOB_FIBERS
+    ucontext_t returnContext;
+    Fiber* prevFiber = _tlsFiber;
+    fiber->returnContext = &returnContext;
+    fiber->state = Fiber::kRunning;
+    _tlsFiber = fiber;
+    swapcontext(&returnContext, &fiber->context);
+    _tlsFiber = prevFiber;
+#else
+    startFiber(fiber);
+#endif
+
+    if (fiber->state == Fiber::kFinished)
+    {
+        //  as with jobs, free the fiber before signaling its counter
+        JobCounter* counter = fiber->counter;
+        freeFiber(fiber);
+        if (counter)
+            signalCounter(counter);
+    }
+    else
+    {
+        //  the fiber is parked only once we're off of its stack, so that
+        //  another worker can't resume it while it's still in use
+        std::lock_guard<std::mutex> lock(_fiberMutex);
+        _waitingFibers.push_back(fiber);
+        //  sequentially consistent with signalCounter(), so that either the
+        //  signaler sees the parked fiber or this worker sees its counter
+        _waitingFiberCount.fetch_add(1);
+    }
+}
+
+bool JobSystem::resumeReadyFiber()
+{
+    if (!_waitingFiberCount.load(std::memory_order_acquire))
+        return false;
+
+    Fiber* ready = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_fiberMutex);
+        for (size_t i = 0; i < _waitingFibers.size(); ++i)
+        {
+            if (_waitingFibers[i]->waitCounter->done())
+            {
+                ready = _waitingFibers[i];
+                _waitingFibers[i] = _waitingFibers.back();
+                _waitingFibers.pop_back();
+                _waitingFiberCount.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+    if (!ready)
+        return false;
+
+    resumeFiber(ready);
+    return true;
+}
+
+bool JobSystem::hasReadyFibers()
+{
+    if (!_waitingFiberCount.load(std::memory_order_acquire))
+        return false;
+
+    std::lock_guard<std::mutex> lock(_fiberMutex);
+    for (auto fiber : _waitingFibers)
+    {
+        if (fiber->waitCounter->done())
+            return true;
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+JobTask::JobTask(JobSystem& jobSystem, EndCallback cb) :
+    Task(std::move(cb)),
+    _jobSystem(jobSystem)
+{
+}
+
+JobTask::~JobTask()
+{
+    _jobSystem.wait(_counter);
+}
+
+void JobTask::onBegin()
+{
+    onDispatch(_jobSystem, _counter);
+}
+
+void JobTask::onUpdate(uint32_t)
+{
+    if (_counter.done())
+    {
+        onJobsComplete();
+    }
+}
+
+void JobTask::onFail()
+{
+    _jobSystem.wait(_counter);
+    Task::onFail();
+}
+
+void JobTask::onCancel()
+{
+    _jobSystem.wait(_counter);
+}
+
+} /* namespace cinek */
@@ -0,0 +1,352 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/jobsystem.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A work-stealing multithreaded job system
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_JOBSYSTEM_HPP
+#define CINEK_JOBSYSTEM_HPP
+
+#include "cinek/task.hpp"
+#include "cinek/vector.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+namespace cinek {
+
+    /** A job entry point, invoked with the job's data pointer */
+    using JobFunction = void (*)(void* data);
+
+    /**
+     * @struct JobDecl
+     * @brief  Declares a job for submission to the JobSystem
+     */
+    struct JobDecl
+    {
+        JobFunction fn;     /**< The job entry point */
+        void* data;         /**< Data passed to the entry point */
+    };
+
+    /**
+     * @class JobCounter
+     * @brief Tracks the number of outstanding jobs in a batch.
+     *
+     * A counter is incremented when jobs are submitted against it and
+     * decremented as each job completes.  The counter must outlive the jobs
+     * submitted against it.
+     */
+    class JobCounter
+    {
+        CK_CLASS_NON_COPYABLE(JobCounter);
+
+    public:
+        JobCounter() : _value(0) {}
+
+        /** @return True if all jobs submitted against this counter finished */
+        bool done() const { return _value.load(std::memory_order_acquire) == 0; }
+        /** @return The number of outstanding jobs */
+        int32_t value() const { return _value.load(std::memory_order_acquire); }
+
+    private:
+        friend class JobSystem;
+        std::atomic<int32_t> _value;
+    };
+
+    /**
+     * @class JobSystem
+     * @brief Executes jobs on a pool of worker threads.
+     *
+     * Each worker owns a work-stealing deque.  Jobs submitted from a worker
+     * (or the thread that created the JobSystem) are pushed onto that thread's
+     * deque, and idle workers steal from the others.  Job records are fixed
+     * size and come from a preallocated pool.
+     *
+     * The thread creating the JobSystem becomes worker zero, and participates
+     * in job execution only when calling wait() or pump().  Jobs submitted
+     * from threads outside of the system go to a shared injection queue.
+     *
+     * Jobs submitted with runFiber() execute on their own stack, taken from
+     * a preallocated pool.  When a fiber job calls wait() on an unfinished
+     * counter, the fiber is suspended and its worker moves on to other
+     * work.  Suspended fibers are resumed by any worker once their counter
+     * reaches zero, so long dependency chains neither block workers nor
+     * grow a worker's stack.  Fibers are available on POSIX platforms;
+     * elsewhere fiber jobs run as regular jobs.
+     */
+    class JobSystem
+    {
+        CK_CLASS_NON_COPYABLE(JobSystem);
+
+    public:
+        enum
+        {
+            /** Size of the inline payload available to callable jobs */
+            kJobPayloadSize = 32,
+            /** Capacity of each worker's deque */
+            kWorkerQueueSize = 4096
+        };
+
+        struct InitParams
+        {
+            /** Number of worker threads including the creating thread.  If
+             *  zero, uses the hardware's concurrency */
+            uint32_t workerCount;
+            /** Number of pooled job records */
+            uint32_t jobLimit;
+            /** Number of pooled fibers available to runFiber */
+            uint32_t fiberLimit = 0;
+            /** Stack size of each pooled fiber, in bytes */
+            uint32_t fiberStackSize = 64 * 1024;
+        };
+
+        JobSystem(const InitParams& params, const Allocator& allocator=Allocator());
+        ~JobSystem();
+
+        /** @return Number of workers, including the creating thread */
+        uint32_t workerCount() const { return (uint32_t)_workers.size(); }
+        /**
+         * @return The index of the calling worker, or -1 if the calling thread
+         *         does not belong to this JobSystem
+         */
+        int32_t currentWorkerIndex() const;
+        /**
+         * Submits a batch of jobs.  If the job pool is exhausted, remaining
+         * jobs execute immediately on the calling thread.
+         *
+         * @param decls     Array of job declarations
+         * @param count     Number of declarations
+         * @param counter   (Optional) Counter incremented by count, and
+         *                  decremented as each job completes.
+         */
+        void run(const JobDecl* decls, uint32_t count, JobCounter* counter);
+        /**
+         * Submits a callable as a job.  The callable is copied into the job
+         * record, and must be trivially copyable and fit within
+         * kJobPayloadSize bytes (i.e. a lambda capturing a few pointers.)
+         *
+         * @param fn        The callable, invoked with no arguments
+         * @param counter   (Optional) Counter tracking the job
+         */
+        template<typename Fn> void run(const Fn& fn, JobCounter* counter);
+        /**
+         * Submits a batch of jobs, each run on a fiber from the pool.  If the
+         * fiber pool is exhausted, remaining jobs run as regular jobs.
+         *
+         * @param decls     Array of job declarations
+         * @param count     Number of declarations
+         * @param counter   (Optional) Counter tracking the jobs
+         */
+        void runFiber(const JobDecl* decls, uint32_t count, JobCounter* counter);
+        /**
+         * Submits a callable as a job run on a fiber.  The callable has the
+         * same restrictions as those passed to run().
+         *
+         * @param fn        The callable, invoked with no arguments
+         * @param counter   (Optional) Counter tracking the job
+         */
+        template<typename Fn> void runFiber(const Fn& fn, JobCounter* counter);
+        /**
+         * Waits until the counter reaches zero.  The calling thread executes
+         * pending jobs while it waits.  If called from a fiber job, the
+         * fiber is instead suspended until the counter reaches zero.
+         *
+         * @param counter   The counter to wait on
+         */
+        void wait(const JobCounter& counter);
+        /**
+         * Executes at most one pending job on the calling thread.  Useful
+         * for cooperative code that polls a counter.
+         *
+         * @return True if a job was executed
+         */
+        bool pump();
+
+    private:
+        struct Job;
+        struct Worker;
+        struct Fiber;
+
+        Job* allocJob();
+        void freeJob(Job* job);
+        void submit(Job* job);
+        void wakeWorker();
+        void signalCounter(JobCounter* counter);
+        Job* findJob(Worker* worker);
+        void execute(Job* job);
+        void workerMain(Worker* worker);
+        bool hasPendingJobs();
+        Worker* currentWorker() const;
+
+        Fiber* allocFiber();
+        void freeFiber(Fiber* fiber);
+        void* fiberPayload(Fiber* fiber);
+        void launchFiber(Fiber* fiber, JobFunction fn, void* data,
+                         JobCounter* counter);
+        void resumeFiber(Fiber* fiber);
+        bool resumeReadyFiber();
+        bool hasReadyFibers();
+        static void startFiber(void* fiber);
+        static void fiberEntry(unsigned int lo, unsigned int hi);
+
+        template<typename Fn> static void invokeCallable(void* data);
+
+        Allocator _allocator;
+        vector<Worker*> _workers;
+
+        Job* _jobs;
+        uint32_t _jobLimit;
+        std::atomic<uint64_t> _freeJobHead;
+
+        std::mutex _injectMutex;
+        vector<Job*> _injected;
+        std::atomic<uint32_t> _injectedCount;
+
+        std::mutex _sleepMutex;
+        std::condition_variable _wakeCondition;
+        std::atomic<uint32_t> _sleeperCount;
+        std::atomic<bool> _running;
+
+        Fiber* _fibers;
+        uint8_t* _fiberStacks;
+        uint32_t _fiberLimit;
+        uint32_t _fiberStackSize;
+        std::mutex _fiberMutex;
+        vector<Fiber*> _freeFibers;
+        //  fibers suspended until their wait counter reaches zero
+        vector<Fiber*> _waitingFibers;
+        std::atomic<uint32_t> _waitingFiberCount;
+
+        static thread_local Worker* _tlsWorker;
+        static thread_local Fiber* _tlsFiber;
+    };
+
+    /**
+     * @class JobTask
+     * @brief A Task that fans work out to a JobSystem.
+     *
+     * The task dispatches jobs once when it begins, then ends on the first
+     * scheduler update after every dispatched job has completed.  Canceled
+     * or failed tasks wait for outstanding jobs before invoking callbacks.
+     */
+    class JobTask : public Task
+    {
+    public:
+        JobTask(JobSystem& jobSystem, EndCallback cb=nullptr);
+        ~JobTask();
+
+    protected:
+        /**
+         * Dispatch jobs using the supplied counter.
+         *
+         * @param jobSystem The JobSystem to submit jobs to
+         * @param counter   The counter to submit jobs against
+         */
+        virtual void onDispatch(JobSystem& jobSystem, JobCounter& counter) = 0;
+        /** Executed on the scheduler's thread once all jobs complete */
+        virtual void onJobsComplete() { end(); }
+
+        void onBegin() override;
+        void onUpdate(uint32_t deltaTimeMs) override;
+        void onFail() override;
+        void onCancel() override;
+
+        JobSystem& jobSystem() { return _jobSystem; }
+
+    private:
+        JobSystem& _jobSystem;
+        JobCounter _counter;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct alignas(64) JobSystem::Job
+    {
+        JobFunction fn;
+        void* data;
+        JobCounter* counter;
+        std::atomic<uint32_t> nextFree;
+        alignas(void*) uint8_t payload[kJobPayloadSize];
+    };
+
+    template<typename Fn> void JobSystem::invokeCallable(void* data)
+    {
+        (*reinterpret_cast<Fn*>(data))();
+    }
+
+    template<typename Fn> void JobSystem::run(const Fn& fn, JobCounter* counter)
+    {
+        static_assert(sizeof(Fn) <= kJobPayloadSize,
+                      "Callable too large for a job's payload");
+        static_assert(std::is_trivially_copyable<Fn>::value &&
+                      std::is_trivially_destructible<Fn>::value,
+                      "Callable must be trivially copyable and destructible");
+
+        if (counter)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+
+        Job* job = allocJob();
+        if (!job)
+        {
+            fn();
+            if (counter)
+                signalCounter(counter);
+            return;
+        }
+        ::new(job->payload) Fn(fn);
+        job->fn = &invokeCallable<Fn>;
+        job->data = job->payload;
+        job->counter = counter;
+        submit(job);
+    }
+
+    template<typename Fn> void JobSystem::runFiber(const Fn& fn, JobCounter* counter)
+    {
+        static_assert(sizeof(Fn) <= kJobPayloadSize,
+                      "Callable too large for a job's payload");
+        static_assert(std::is_trivially_copyable<Fn>::value &&
+                      std::is_trivially_destructible<Fn>::value,
+                      "Callable must be trivially copyable and destructible");
+
+        Fiber* fiber = allocFiber();
+        if (!fiber)
+        {
+            run(fn, counter);
+            return;
+        }
+        void* payload = fiberPayload(fiber);
+        ::new(payload) Fn(fn);
+        if (counter)
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        launchFiber(fiber, &invokeCallable<Fn>, payload, counter);
+    }
+
+} /* namespace cinek */
+
+#endif
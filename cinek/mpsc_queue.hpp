@@ -0,0 +1,153 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/mpsc_queue.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   An intrusive, lock-free multiple producer single consumer queue
+ * @copyright Cinekine
+ */
+
+/*
+ * Based on Dmitry Vyukov's "Intrusive MPSC node-based queue".  Producers
+ * exchange themselves into the head of the queue with a single atomic
+ * operation, and the consumer follows the links from the tail.  A stub node
+ * owned by the queue keeps the queue from ever becoming truly empty.
+ *
+ * Nodes are linked using the same __nextListNode member used by
+ * intrusive_list, so objects held in intrusive lists may be passed through
+ * the queue while they're not in a list.
+ */
+
+#ifndef CINEK_MPSC_QUEUE_HPP
+#define CINEK_MPSC_QUEUE_HPP
+
+#include "cinek/types.hpp"
+
+#include <atomic>
+
+namespace cinek {
+
+template<typename Node>
+class IntrusiveMPSCQueue
+{
+    CK_CLASS_NON_COPYABLE(IntrusiveMPSCQueue);
+
+    using AtomicLink = std::atomic<Node*>;
+
+    static_assert(sizeof(AtomicLink) == sizeof(Node*) &&
+                  alignof(AtomicLink) == alignof(Node*),
+                  "Node links must be usable as atomics");
+
+public:
+    IntrusiveMPSCQueue();
+
+    /** Any thread.  Appends the node to the queue */
+    void push(Node* node);
+    /** Consumer only.  Returns nullptr if the queue is empty, or if a
+     *  producer is mid-push (the node will be available on a later pop) */
+    Node* pop();
+    /** Consumer only.  A hint, since producers may push at any time */
+    bool empty() const;
+
+private:
+    static AtomicLink& link(Node* node) {
+        return *reinterpret_cast<AtomicLink*>(&node->__nextListNode);
+    }
+
+    //  popped nodes are returned unlinked, ready for insertion into lists
+    static Node* unlinked(Node* node) {
+        link(node).store(nullptr, std::memory_order_relaxed);
+        return node;
+    }
+
+    std::atomic<Node*> _head;
+    Node* _tail;
+    Node _stub;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename Node>
+IntrusiveMPSCQueue<Node>::IntrusiveMPSCQueue() :
+    _head(&_stub),
+    _tail(&_stub),
+    _stub()
+{
+    link(&_stub).store(nullptr, std::memory_order_relaxed);
+}
+
+template<typename Node>
+void IntrusiveMPSCQueue<Node>::push(Node* node)
+{
+    link(node).store(nullptr, std::memory_order_relaxed);
+    Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+    //  the queue is momentarily broken between the exchange and this store,
+    //  which pop() detects
+    link(prev).store(node, std::memory_order_release);
+}
+
+template<typename Node>
+Node* IntrusiveMPSCQueue<Node>::pop()
+{
+    Node* tail = _tail;
+    Node* next = link(tail).load(std::memory_order_acquire);
+    if (tail == &_stub)
+    {
+        if (!next)
+            return nullptr;
+        _tail = next;
+        tail = next;
+        next = link(next).load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        _tail = next;
+        return unlinked(tail);
+    }
+    if (tail != _head.load(std::memory_order_acquire))
+        return nullptr;
+
+    //  tail is the last node; the stub is pushed behind it so that tail can
+    //  be unlinked
+    push(&_stub);
+    next = link(tail).load(std::memory_order_acquire);
+    if (next)
+    {
+        _tail = next;
+        return unlinked(tail);
+    }
+    return nullptr;
+}
+
+template<typename Node>
+bool IntrusiveMPSCQueue<Node>::empty() const
+{
+    return _tail == &_stub &&
+        !reinterpret_cast<const AtomicLink*>(&_stub.__nextListNode)->load(
+            std::memory_order_acquire);
+}
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/parallel.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Parallel-for and parallel-reduce over a JobSystem
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_PARALLEL_HPP
+#define CINEK_PARALLEL_HPP
+
+#include "cinek/jobsystem.hpp"
+
+namespace cinek {
+
+    /** Target number of chunks per worker when choosing a grain size */
+    constexpr uint32_t kParallelChunksPerWorker = 8;
+    /** Smallest grain chosen automatically, so that tiny ranges run
+     *  serially */
+    constexpr uint32_t kParallelMinGrain = 64;
+    /** Maximum number of partial results kept by parallelReduce */
+    constexpr uint32_t kParallelMaxReduceChunks = 64;
+
+    /**
+     * Selects a grain size for a range.  A nonzero requested grain is kept
+     * as-is, otherwise the range is split into a few chunks per worker so
+     * that idle workers have something to steal without drowning the
+     * queues in tiny jobs.
+     *
+     * @param  jobSystem    The JobSystem running the range
+     * @param  count        Number of iterations in the range
+     * @param  grain        Requested grain, or zero to choose automatically
+     * @return The number of iterations handled by a single job
+     */
+    inline uint32_t parallelGrain(const JobSystem& jobSystem, uint32_t count,
+                                  uint32_t grain)
+    {
+        if (grain)
+            return grain;
+        grain = count / (jobSystem.workerCount() * kParallelChunksPerWorker);
+        return grain < kParallelMinGrain ? kParallelMinGrain : grain;
+    }
+
+    template<typename Fn>
+    struct ParallelForContext
+    {
+        JobSystem* jobSystem;
+        const Fn* fn;
+        JobCounter* counter;
+        uint32_t grain;
+    };
+
+    template<typename Fn>
+    void parallelForRange(const ParallelForContext<Fn>* context,
+                          uint32_t first, uint32_t last)
+    {
+        //  split off the upper half of the range as a job until the
+        //  remainder fits the grain - splitting happens on whichever
+        //  worker picks up a job, so the range spreads quickly
+        while (last - first > context->grain)
+        {
+            uint32_t mid = first + (last - first) / 2;
+            context->jobSystem->run([context, mid, last]() {
+                parallelForRange(context, mid, last);
+            }, context->counter);
+            last = mid;
+        }
+        (*context->fn)(first, last);
+    }
+
+    /**
+     * Invokes fn over subranges of [begin, end) across the JobSystem's
+     * workers, returning once the whole range has been processed.  Ranges
+     * no larger than the grain, or a single-worker JobSystem, run serially
+     * on the calling thread without scheduling any jobs.
+     *
+     * @param jobSystem The JobSystem executing the loop
+     * @param begin     First index of the range
+     * @param end       One past the last index of the range
+     * @param grain     Iterations per job, or zero to choose automatically
+     * @param fn        Callable invoked as fn(first, last) for each
+     *                  subrange.  Must be safe to call concurrently.
+     */
+    template<typename Fn>
+    void parallelFor(JobSystem& jobSystem, uint32_t begin, uint32_t end,
+                     uint32_t grain, const Fn& fn)
+    {
+        if (end <= begin)
+            return;
+
+        grain = parallelGrain(jobSystem, end - begin, grain);
+        if (end - begin <= grain || jobSystem.workerCount() < 2)
+        {
+            fn(begin, end);
+            return;
+        }
+
+        JobCounter counter;
+        ParallelForContext<Fn> context { &jobSystem, &fn, &counter, grain };
+        parallelForRange(&context, begin, end);
+        jobSystem.wait(counter);
+    }
+
+    /**
+     * Reduces [begin, end) across the JobSystem's workers.  The range is
+     * split into at most kParallelMaxReduceChunks chunks, each mapped to a
+     * partial result.  Partials are combined in range order on the calling
+     * thread, so the result is deterministic for a given grain and worker
+     * count even if combine is not strictly associative (i.e. floating
+     * point sums.)
+     *
+     * @param  jobSystem    The JobSystem executing the reduction
+     * @param  begin        First index of the range
+     * @param  end          One past the last index of the range
+     * @param  grain        Minimum iterations per chunk, or zero to choose
+     *                      automatically
+     * @param  identity     The identity value of combine.  T must be default
+     *                      constructible and copy assignable
+     * @param  map          Callable invoked as map(first, last), returning
+     *                      the partial T for the subrange
+     * @param  combine      Callable invoked as combine(T, T), returning T
+     * @return The combined result, or identity for an empty range
+     */
+    template<typename T, typename MapFn, typename CombineFn>
+    T parallelReduce(JobSystem& jobSystem, uint32_t begin, uint32_t end,
+                     uint32_t grain, const T& identity, const MapFn& map,
+                     const CombineFn& combine)
+    {
+        if (end <= begin)
+            return identity;
+
+        const uint32_t count = end - begin;
+        grain = parallelGrain(jobSystem, count, grain);
+        if (count <= grain || jobSystem.workerCount() < 2)
+            return combine(identity, map(begin, end));
+
+        uint32_t chunkCount = (count + grain - 1) / grain;
+        if (chunkCount > kParallelMaxReduceChunks)
+        {
+            chunkCount = kParallelMaxReduceChunks;
+            grain = (count + chunkCount - 1) / chunkCount;
+            chunkCount = (count + grain - 1) / grain;
+        }
+
+        struct Context
+        {
+            const MapFn* map;
+            T* partials;
+            uint32_t begin;
+            uint32_t end;
+            uint32_t grain;
+        };
+
+        T partials[kParallelMaxReduceChunks];
+        Context context { &map, partials, begin, end, grain };
+        JobCounter counter;
+
+        //  the caller maps the first chunk itself rather than idling
+        for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+        {
+            const Context* ctx = &context;
+            jobSystem.run([ctx, chunk]() {
+                uint32_t first = ctx->begin + chunk * ctx->grain;
+                uint32_t last = first + ctx->grain;
+                if (last > ctx->end || last < first)
+                    last = ctx->end;
+                ctx->partials[chunk] = (*ctx->map)(first, last);
+            }, &counter);
+        }
+        partials[0] = map(begin, begin + grain);
+        jobSystem.wait(counter);
+
+        T result = identity;
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+            result = combine(result, partials[chunk]);
+        return result;
+    }
+
+} /* namespace cinek */
+
+#endif
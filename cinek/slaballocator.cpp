@@ -0,0 +1,245 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/slaballocator.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Size-class slab allocation for small, short-lived objects
+ * @copyright Cinekine
+ */
+
+#include "cinek/slaballocator.hpp"
+#include "cinek/debug.h"
+
+#include <cstring>
+
+namespace cinek {
+
+//  precedes every block handed out, recording the block's size class so that
+//  free() needs only the pointer.
+struct alignas(SlabAllocator::kBlockAlignment) SlabAllocator::BlockHeader
+{
+    uint32_t sizeClass;
+    uint32_t reserved;
+    size_t size;
+};
+
+namespace {
+    const uint32_t kOversizeClass = 0xffffffff;
+
+    uint32_t sizeClassFromSize(size_t size)
+    {
+        uint32_t sizeClass = 0;
+        size_t blockSize = SlabAllocator::kSmallestBlockSize;
+        while (blockSize < size && sizeClass < SlabAllocator::kSizeClassCount)
+        {
+            blockSize <<= 1;
+            ++sizeClass;
+        }
+        return sizeClass < SlabAllocator::kSizeClassCount ? sizeClass : kOversizeClass;
+    }
+
+    size_t blockSizeFromClass(uint32_t sizeClass)
+    {
+        return (size_t)SlabAllocator::kSmallestBlockSize << sizeClass;
+    }
+}
+
+SlabAllocator::SlabAllocator
+(
+    size_t slabSize,
+    const Allocator& allocator,
+    bool threadSafe
+) :
+    _allocator(allocator),
+    _slabSize(slabSize),
+    _slabs(nullptr),
+    _slabCount(0),
+    _threadSafe(threadSafe)
+{
+    for (auto& freeList : _freeLists)
+        freeList = nullptr;
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    while (_slabs)
+    {
+        Slab* next = _slabs->next;
+        _allocator.freeAligned(_slabs);
+        _slabs = next;
+    }
+}
+
+bool SlabAllocator::allocSlab(uint32_t sizeClass)
+{
+    const size_t blockSize = blockSizeFromClass(sizeClass);
+    const size_t headerSize = CK_ALIGN_SIZE(sizeof(Slab), (size_t)kBlockAlignment);
+    size_t slabSize = _slabSize;
+    if (slabSize < headerSize + blockSize)
+        slabSize = headerSize + blockSize;
+
+    uint8_t* mem = reinterpret_cast<uint8_t*>(
+        _allocator.allocAligned(slabSize, kBlockAlignment));
+    if (!mem)
+        return false;
+
+    Slab* slab = reinterpret_cast<Slab*>(mem);
+    slab->next = _slabs;
+    _slabs = slab;
+    ++_slabCount;
+
+    //  carve the slab into blocks for this size class
+    uint8_t* block = mem + headerSize;
+    uint8_t* limit = mem + slabSize;
+    FreeBlock* head = _freeLists[sizeClass];
+    while (block + blockSize <= limit)
+    {
+        FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(block);
+        freeBlock->next = head;
+        head = freeBlock;
+        block += blockSize;
+    }
+    _freeLists[sizeClass] = head;
+    return true;
+}
+
+void* SlabAllocator::alloc(size_t size)
+{
+    const size_t totalSize = size + sizeof(BlockHeader);
+    const uint32_t sizeClass = sizeClassFromSize(totalSize);
+
+    BlockHeader* header;
+    if (sizeClass == kOversizeClass)
+    {
+        header = reinterpret_cast<BlockHeader*>(
+            _allocator.allocAligned(totalSize, kBlockAlignment));
+        if (!header)
+            return nullptr;
+    }
+    else
+    {
+        header = reinterpret_cast<BlockHeader*>(allocBlock(sizeClass));
+        if (!header)
+            return nullptr;
+    }
+
+    header->sizeClass = sizeClass;
+    header->size = size;
+    return header + 1;
+}
+
+void SlabAllocator::free(void* p)
+{
+    if (!p)
+        return;
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(p) - 1;
+    const uint32_t sizeClass = header->sizeClass;
+    if (sizeClass == kOversizeClass)
+    {
+        _allocator.freeAligned(header);
+        return;
+    }
+
+    CK_ASSERT(sizeClass < kSizeClassCount);
+    freeBlock(header, sizeClass);
+}
+
+void* SlabAllocator::allocBlock(uint32_t sizeClass)
+{
+    std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+    if (_threadSafe)
+        lock.lock();
+
+    if (!_freeLists[sizeClass] && !allocSlab(sizeClass))
+        return nullptr;
+    FreeBlock* block = _freeLists[sizeClass];
+    _freeLists[sizeClass] = block->next;
+    return block;
+}
+
+void SlabAllocator::freeBlock(void* p, uint32_t sizeClass)
+{
+    std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+    if (_threadSafe)
+        lock.lock();
+
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(p);
+    block->next = _freeLists[sizeClass];
+    _freeLists[sizeClass] = block;
+}
+
+void* SlabAllocator::realloc(void* p, size_t size)
+{
+    if (!p)
+        return alloc(size);
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(p) - 1;
+    void* newp = alloc(size);
+    if (newp)
+    {
+        memcpy(newp, p, header->size < size ? header->size : size);
+        free(p);
+    }
+    return newp;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    void* slabAlloc(void* ctx, size_t numBytes)
+    {
+        return reinterpret_cast<SlabAllocator*>(ctx)->alloc(numBytes);
+    }
+
+    void* slabAllocAligned(void* ctx, size_t numBytes, size_t align)
+    {
+        CK_ASSERT_RETURN_VALUE(align <= SlabAllocator::kBlockAlignment, nullptr);
+        return reinterpret_cast<SlabAllocator*>(ctx)->alloc(numBytes);
+    }
+
+    void slabFree(void* ctx, void* ptr)
+    {
+        reinterpret_cast<SlabAllocator*>(ctx)->free(ptr);
+    }
+
+    void* slabRealloc(void* ctx, void* ptr, size_t numBytes)
+    {
+        return reinterpret_cast<SlabAllocator*>(ctx)->realloc(ptr, numBytes);
+    }
+}
+
+cinek_memory_callbacks SlabAllocator::callbacks()
+{
+    cinek_memory_callbacks cbs;
+    cbs.alloc = &slabAlloc;
+    cbs.alloc_aligned = &slabAllocAligned;
+    cbs.free = &slabFree;
+    cbs.free_aligned = &slabFree;
+    cbs.realloc = &slabRealloc;
+    cbs.context = this;
+    return cbs;
+}
+
+} /* namespace cinek */
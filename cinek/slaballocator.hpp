@@ -0,0 +1,131 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/slaballocator.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Size-class slab allocation for small, short-lived objects
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_SLAB_ALLOCATOR_HPP
+#define CINEK_SLAB_ALLOCATOR_HPP
+
+#include "cinek/allocator.hpp"
+
+#include <mutex>
+
+namespace cinek {
+
+    /**
+     * @class SlabAllocator
+     * @brief Allocates small blocks from power-of-two size classes.
+     *
+     * Each size class carves blocks from slabs obtained from the backing
+     * allocator.  Freed blocks return to their class's free list and slabs
+     * are only released when the SlabAllocator is destroyed, so a workload
+     * with a steady population of objects stops touching the backing
+     * allocator once warmed up.  Requests larger than the largest size
+     * class are forwarded to the backing allocator.
+     *
+     * Not thread-safe unless constructed with threadSafe set, in which case
+     * alloc and free serialize on a mutex.  Requests forwarded to the
+     * backing allocator are not serialized.
+     */
+    class SlabAllocator
+    {
+        CK_CLASS_NON_COPYABLE(SlabAllocator);
+
+    public:
+        enum
+        {
+            kSmallestBlockSize = 64,
+            kSizeClassCount = 6,        /**< 64 to 2048 byte blocks */
+            kBlockAlignment = 16        /**< Alignment of returned blocks */
+        };
+
+        /**
+         * Constructor
+         *
+         * @param slabSize  The size of each slab in bytes
+         * @param allocator  The backing allocator
+         * @param threadSafe If true, blocks may be allocated and freed from
+         *                   any thread
+         */
+        explicit SlabAllocator(size_t slabSize=16384,
+                               const Allocator& allocator=Allocator(),
+                               bool threadSafe=false);
+        ~SlabAllocator();
+
+        /**
+         * @param  size Bytes to allocate
+         * @return The allocated block or nullptr
+         */
+        void* alloc(size_t size);
+        /**
+         * @param  p    A block returned from alloc (or nullptr)
+         */
+        void free(void* p);
+        /**
+         * Resizes a block, copying its contents into the new block.
+         *
+         * @param  p    A block returned from alloc (or nullptr)
+         * @param  size The new size
+         * @return The new block or nullptr
+         */
+        void* realloc(void* p, size_t size);
+        /**
+         * @return Callbacks routing allocations to this SlabAllocator, for
+         *         use with an Allocator or cinek_alloc_set_callbacks
+         */
+        cinek_memory_callbacks callbacks();
+        /** @return Number of slabs obtained from the backing allocator */
+        size_t slabCount() const { return _slabCount; }
+
+    private:
+        struct BlockHeader;
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+        struct Slab
+        {
+            Slab* next;
+        };
+
+        bool allocSlab(uint32_t sizeClass);
+        void* allocBlock(uint32_t sizeClass);
+        void freeBlock(void* p, uint32_t sizeClass);
+
+        Allocator _allocator;
+        size_t _slabSize;
+        FreeBlock* _freeLists[kSizeClassCount];
+        Slab* _slabs;
+        size_t _slabCount;
+        bool _threadSafe;
+        std::mutex _mutex;
+    };
+
+} /* namespace cinek */
+
+#endif
@@ -36,17 +36,40 @@
  */
 
 #include "cinek/task.hpp"
+#include "cinek/debug.h"
 
 namespace cinek {
 
 Task::Task(EndCallback cb) :
     _state(State::kIdle),
+    _priority(Priority::kNormal),
+    _parallelSafe(false),
     _schedulerHandle(0),
-    _endCb(cb),
-    _schedulerContext(nullptr)
+    _endCb(std::move(cb)),
+    _schedulerContext(nullptr),
+    _contextPrev(nullptr),
+    _contextNext(nullptr),
+    _sleepMs(0),
+    _periodMs(0),
+    _timerSlot(kTimerSlotNone),
+    _timerExpiry(0),
+    _timerStart(0),
+    _lastRunFrame(0)
 {
 }
 
+void Task::setPriority(Priority priority)
+{
+    CK_ASSERT_RETURN(_state == State::kIdle);
+    _priority = priority;
+}
+
+void Task::setParallelSafe(bool parallelSafe)
+{
+    CK_ASSERT_RETURN(_state == State::kIdle);
+    _parallelSafe = parallelSafe;
+}
+
 void Task::setNextTask(unique_ptr<Task>&& task)
 {
     _nextTask = std::move(task);
@@ -40,11 +40,11 @@
 
 #include "cinek/types.hpp"
 #include "cinek/allocator.hpp"
-
-#include <functional>
+#include "cinek/delegate.hpp"
 
 namespace cinek {
     class TaskScheduler;
+    class TaskTimerWheel;
 }
 
 namespace cinek {
@@ -79,16 +79,46 @@ namespace cinek {
             kFailed,    /**< Task has failed as a result of calling fail() */
             kCanceled   /**< Task was canceled */
         };
+
+        /** Task Priorities, in order of execution during a scheduler update */
+        enum class Priority
+        {
+            kCritical,  /**< Always updated, regardless of time budget */
+            kHigh,      /**< Updated before normal priority tasks */
+            kNormal,    /**< The default priority */
+            kLow,       /**< Updated last, and first to be deferred */
+            kCount
+        };
         
-        using EndCallback = std::function<void(State, Task&, void*)>;
+        /** Callbacks are stored inline and must fit within the delegate */
+        using EndCallback = Delegate<void(State, Task&, void*)>;
         
-        Task(EndCallback _cb=0);
+        Task(EndCallback _cb=nullptr);
         virtual ~Task() = default;
         
         /**
          *  @param  cb      The callback executed upon an end or fail result.
          */
         void setCallback(EndCallback cb) { _endCb = std::move(cb); }
+        /**
+         *  Sets the task's priority.  Must be called before scheduling.
+         *
+         *  @param  priority    The task's priority class
+         */
+        void setPriority(Priority priority);
+        /** @return The task's priority class */
+        Priority priority() const { return _priority; }
+        /**
+         *  Marks the task as safe to update concurrently with other tasks.
+         *  A parallel-safe task's onUpdate may run on a worker thread, and
+         *  must only touch data owned by the task.  Must be called before
+         *  scheduling.
+         *
+         *  @param  parallelSafe    True if the task is parallel-safe
+         */
+        void setParallelSafe(bool parallelSafe);
+        /** @return True if the task is parallel-safe */
+        bool isParallelSafe() const { return _parallelSafe; }
 
         /**
          * Attach the task to be executed when this Task successfully completes.
@@ -138,6 +168,14 @@ namespace cinek {
          * invoke any subsequent task on this task's chain.
          */
         void fail();
+        /**
+         * Suspends updates to this task for a duration.  The task remains
+         * scheduled, but its scheduler won't touch it until it wakes.  Takes
+         * effect once the current onBegin() or onUpdate() returns.
+         *
+         * @param ms    The sleep duration in milliseconds
+         */
+        void sleep(uint32_t ms) { _sleepMs = ms; }
         /**
          *  @return The next task to be executed or nullptr if there's none
          *          scheduled.
@@ -146,12 +184,35 @@ namespace cinek {
 
     private:
         friend class TaskScheduler;
+        friend class TaskTimerWheel;
+
+        enum : uint32_t
+        {
+            kTimerSlotExpired = 0xfffffffe,
+            kTimerSlotNone = 0xffffffff
+        };
 
         State _state;
+        Priority _priority;
+        bool _parallelSafe;
         TaskId _schedulerHandle;
         unique_ptr<Task> _nextTask;
         EndCallback _endCb;
         void *_schedulerContext;
+        //  frees the task while it's queued by scheduleFromAnyThread
+        Allocator _submitAllocator;
+        //  links to tasks scheduled with the same (non-null) context
+        Task* _contextPrev;
+        Task* _contextNext;
+        //  timer state, managed by the scheduler and its TaskTimerWheel
+        uint32_t _sleepMs;
+        uint32_t _periodMs;
+        uint32_t _timerSlot;
+        uint64_t _timerExpiry;
+        uint64_t _timerStart;
+        //  the scheduler update count when the task last ran, used to
+        //  detect starvation of deferred tasks
+        uint32_t _lastRunFrame;
     };
 
 } /* namespace cinek */
@@ -0,0 +1,147 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/taskgraph.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A reusable graph of dependent tasks
+ * @copyright Cinekine
+ */
+
+#include "cinek/taskgraph.hpp"
+#include "cinek/debug.h"
+
+namespace cinek {
+
+TaskGraph::TaskGraph(const Allocator& allocator) :
+    _allocator(allocator),
+    _nodes(allocator),
+    _edges(allocator),
+    _successors(allocator),
+    _remaining(0),
+    _failed(false),
+    _dirty(false)
+{
+}
+
+auto TaskGraph::add(unique_ptr<Task>&& task) -> NodeIndex
+{
+    CK_ASSERT(!isRunning());
+    _nodes.emplace_back();
+    Node& node = _nodes.back();
+    node.task = std::move(task);
+    node.firstSuccessor = 0;
+    node.successorCount = 0;
+    node.predecessorCount = 0;
+    node.pending = 0;
+    node.skip = false;
+    _dirty = true;
+    return (NodeIndex)(_nodes.size() - 1);
+}
+
+void TaskGraph::precede(NodeIndex before, NodeIndex after)
+{
+    CK_ASSERT_RETURN(!isRunning());
+    CK_ASSERT_RETURN(before < _nodes.size() && after < _nodes.size());
+    CK_ASSERT_RETURN(before != after);
+    _edges.push_back({ before, after });
+    _dirty = true;
+}
+
+bool TaskGraph::build()
+{
+    //  lays out successor lists contiguously, ordered by predecessor
+    for (auto& node : _nodes)
+    {
+        node.successorCount = 0;
+        node.predecessorCount = 0;
+    }
+    for (auto& edge : _edges)
+    {
+        ++_nodes[edge.before].successorCount;
+        ++_nodes[edge.after].predecessorCount;
+    }
+    uint32_t offset = 0;
+    for (auto& node : _nodes)
+    {
+        node.firstSuccessor = offset;
+        offset += node.successorCount;
+        node.pending = 0;
+    }
+    _successors.resize(_edges.size());
+    for (auto& edge : _edges)
+    {
+        Node& node = _nodes[edge.before];
+        _successors[node.firstSuccessor + node.pending] = edge.after;
+        ++node.pending;
+    }
+
+    //  a graph containing a cycle would never finish.  visit nodes in
+    //  dependency order; any not visited are part of a cycle
+    vector<NodeIndex> ready(_allocator);
+    ready.reserve(_nodes.size());
+    for (NodeIndex i = 0; i < _nodes.size(); ++i)
+    {
+        _nodes[i].pending = _nodes[i].predecessorCount;
+        if (!_nodes[i].pending)
+            ready.push_back(i);
+    }
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+        const Node& node = _nodes[ready[i]];
+        for (uint32_t s = 0; s < node.successorCount; ++s)
+        {
+            NodeIndex successor = _successors[node.firstSuccessor + s];
+            if (!--_nodes[successor].pending)
+                ready.push_back(successor);
+        }
+    }
+    if (ready.size() != _nodes.size())
+    {
+        CK_LOG_ERROR("TaskGraph", "Graph contains a cycle!");
+        return false;
+    }
+
+    _dirty = false;
+    return true;
+}
+
+bool TaskGraph::prepare()
+{
+    CK_ASSERT_RETURN_VALUE(!isRunning(), false);
+    if (_nodes.empty())
+        return false;
+    if (_dirty && !build())
+        return false;
+
+    for (auto& node : _nodes)
+    {
+        node.pending = node.predecessorCount;
+        node.skip = false;
+    }
+    _remaining = (uint32_t)_nodes.size();
+    _failed = false;
+    return true;
+}
+
+} /* namespace cinek */
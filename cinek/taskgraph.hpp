@@ -0,0 +1,133 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/taskgraph.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A reusable graph of dependent tasks
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_TASK_GRAPH_HPP
+#define CINEK_TASK_GRAPH_HPP
+
+#include "cinek/task.hpp"
+#include "cinek/vector.hpp"
+
+namespace cinek {
+
+    class TaskScheduler;
+
+    /**
+     *  @class  TaskGraph
+     *  @brief  A set of tasks with dependencies, run by a TaskScheduler
+     *
+     *  Each task in the graph becomes runnable once all of its predecessors
+     *  have ended, allowing fan-out and fan-in between tasks.  If a task
+     *  fails or is canceled, tasks depending on it are skipped.
+     *
+     *  The graph owns its tasks, which are reset and re-run each time the
+     *  graph is scheduled, so a built graph may be run every frame without
+     *  allocating.  Tasks should reinitialize their own state in onBegin.
+     *  The graph must not be destroyed while it's running.
+     */
+    class TaskGraph
+    {
+        CK_CLASS_NON_COPYABLE(TaskGraph);
+
+    public:
+        using NodeIndex = uint32_t;
+
+        /**
+         *  Constructor
+         *
+         *  @param  allocator   An optional allocator
+         */
+        explicit TaskGraph(const Allocator& allocator=Allocator());
+        /**
+         *  Adds a task to the graph.  The graph must not be running.
+         *
+         *  @param  task    The task to add
+         *  @return The task's index within the graph
+         */
+        NodeIndex add(unique_ptr<Task>&& task);
+        /**
+         *  Declares that one task must end before another may begin.  The
+         *  graph must not be running.
+         *
+         *  @param  before  The predecessor task's index
+         *  @param  after   The successor task's index
+         */
+        void precede(NodeIndex before, NodeIndex after);
+        /**
+         *  @param  index   The task's index within the graph
+         *  @return The task at the specified index
+         */
+        Task* task(NodeIndex index) const { return _nodes[index].task.get(); }
+        /** @return The number of tasks in the graph */
+        uint32_t size() const { return (uint32_t)_nodes.size(); }
+        /** @return True if the graph has been scheduled and not finished */
+        bool isRunning() const { return _remaining > 0; }
+        /**
+         *  @return True if every task in the graph's most recent run ended
+         *          successfully
+         */
+        bool succeeded() const { return !_failed; }
+
+    private:
+        friend class TaskScheduler;
+
+        struct Node
+        {
+            unique_ptr<Task> task;
+            uint32_t firstSuccessor;
+            uint32_t successorCount;
+            uint32_t predecessorCount;
+            //  predecessors remaining during a run
+            uint32_t pending;
+            //  set if a predecessor didn't end successfully
+            bool skip;
+        };
+
+        struct Edge
+        {
+            NodeIndex before;
+            NodeIndex after;
+        };
+
+        bool prepare();
+        bool build();
+
+        Allocator _allocator;
+        vector<Node> _nodes;
+        vector<Edge> _edges;
+        //  successors of each node, indexed by Node::firstSuccessor
+        vector<NodeIndex> _successors;
+        uint32_t _remaining;
+        bool _failed;
+        bool _dirty;
+    };
+
+} /* namespace cinek */
+
+#endif
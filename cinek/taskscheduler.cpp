@@ -30,151 +30,752 @@
  */
 
 #include "cinek/taskscheduler.hpp"
+#include "cinek/jobsystem.hpp"
+#include "cinek/tasktracer.hpp"
 #include "cinek/debug.h"
+
 #include <algorithm>
+#include <chrono>
 
 namespace cinek {
 
-bool operator<(const unique_ptr<Task>& l, TaskId r)
+TaskScheduler::TaskScheduler
+(
+    uint32_t taskLimit,
+    const Allocator& allocator
+) :
+    _taskPool(16384, allocator, true),
+    _taskPoolCallbacks(_taskPool.callbacks()),
+    _taskAllocator(&_taskPoolCallbacks),
+    _parallelBatch(allocator),
+    _jobSystem(nullptr),
+    _tracer(nullptr),
+    _frame(0),
+    _starvationLimit(8),
+    _stats(),
+    _slots(allocator),
+    _contextTable(allocator),
+    _contextCount(0),
+    _freeHead(kNullSlot),
+    _freeTail(kNullSlot)
 {
-    return l.get()->id() < r;
+    _slots.reserve(taskLimit);
+
+    uint32_t contextTableSize = 16;
+    while (contextTableSize < taskLimit * 2 && contextTableSize < 0x80000000u)
+        contextTableSize *= 2;
+    _contextTable.resize(contextTableSize, ContextEntry { nullptr, nullptr });
 }
 
-TaskScheduler::TaskScheduler(uint32_t taskLimit, const Allocator& allocator) :
-    _tasks(allocator),
-    _currentHandle(0)
+TaskScheduler::~TaskScheduler()
 {
-    _tasks.reserve(taskLimit);
+    //  destroy tasks before the pool they may have been allocated from
+    while (TaskListNode* node = _submitQueue.pop())
+    {
+        Task* task = static_cast<Task*>(node);
+        unique_ptr<Task> owner(task, task->_submitAllocator);
+    }
+    for (auto& runList : _runLists)
+        runList.clear();
+    _wokenList.clear();
+    _parallelList.clear();
+    _timerWheel.clear();
+    //  graphs interrupted mid-run are left idle, so they may be run again
+    for (auto& slot : _slots)
+    {
+        if (slot.graph)
+        {
+            slot.graph->_remaining = 0;
+            slot.graph->_failed = true;
+        }
+    }
+    _slots.clear();
+    _contextTable.clear();
+    _contextCount = 0;
 }
 
 TaskId TaskScheduler::schedule(unique_ptr<Task>&& task, void* context)
 {
-    ++_currentHandle;
-    if (!_currentHandle)
-        _currentHandle = 1;
+    Task* taskPtr = task.get();
+    TaskId handle = attach(std::move(task), context);
+    if (handle)
+    {
+        enqueue(taskPtr);
+    }
+    return handle;
+}
+
+void TaskScheduler::scheduleFromAnyThread
+(
+    unique_ptr<Task>&& task,
+    void* context
+)
+{
+    //  the task is idle, so these fields are free until it's scheduled
+    task->_schedulerContext = context;
+    task->_submitAllocator = task.get_deleter()._allocator;
+    _submitQueue.push(task.release());
+}
+
+void TaskScheduler::drainSubmissions()
+{
+    while (TaskListNode* node = _submitQueue.pop())
+    {
+        Task* task = static_cast<Task*>(node);
+        unique_ptr<Task> owner(task, task->_submitAllocator);
+        schedule(std::move(owner), task->_schedulerContext);
+    }
+}
+
+TaskId TaskScheduler::scheduleAfter
+(
+    unique_ptr<Task>&& task,
+    uint32_t delayMs,
+    void* context
+)
+{
+    if (!delayMs)
+        return schedule(std::move(task), context);
+
+    Task* taskPtr = task.get();
+    TaskId handle = attach(std::move(task), context);
+    if (handle)
+    {
+        taskPtr->_timerStart = time();
+        _timerWheel.insert(taskPtr, time() + delayMs);
+    }
+    return handle;
+}
+
+TaskId TaskScheduler::schedulePeriodic
+(
+    unique_ptr<Task>&& task,
+    uint32_t periodMs,
+    void* context
+)
+{
+    task->_periodMs = periodMs;
+    return scheduleAfter(std::move(task), periodMs, context);
+}
+
+TaskId TaskScheduler::attach(unique_ptr<Task>&& task, void* context)
+{
+    TaskId handle = attach(task.get(), context);
+    if (handle)
+    {
+        //  the slot owns the task
+        _slots[handle & kSlotIndexMask].owner = std::move(task);
+    }
+    return handle;
+}
 
-    auto it = std::lower_bound(_tasks.begin(), _tasks.end(), _currentHandle);
-    if (it != _tasks.end())
+TaskId TaskScheduler::attach(Task* task, void* context)
+{
+    uint32_t index;
+    if (_freeHead != kNullSlot)
+    {
+        index = _freeHead;
+        _freeHead = _slots[index].nextFree;
+        if (_freeHead == kNullSlot)
+            _freeTail = kNullSlot;
+    }
+    else
     {
-        if ((*it).get()->id() == _currentHandle)
+        index = (uint32_t)_slots.size();
+        if (index > kSlotIndexMask)
         {
-            CK_LOG_ERROR("TaskScheduler", "Handle %u already exists in task list!",
-                         _currentHandle);
+            CK_LOG_ERROR("TaskScheduler", "Task limit %u exceeded!",
+                         kSlotIndexMask + 1);
             return 0;
         }
+        _slots.emplace_back();
+        _slots.back().generation = 1;
     }
-    //  add to our processing list
-    _runList.push_back(task.get());
+
+    TaskSlot& slot = _slots[index];
+    slot.nextFree = kNullSlot;
+    slot.task = task;
+    slot.graph = nullptr;
+    slot.graphNode = 0;
+    TaskId handle = (slot.generation << kSlotIndexBits) | index;
+
     task->_state = Task::State::kStaged;
-    task->_schedulerHandle = _currentHandle;
+    task->_schedulerHandle = handle;
     task->_schedulerContext = context;
-    //  place owned reference onto our searchable list
-    _tasks.emplace(it, std::move(task));
+    linkContext(task);
+
+    return handle;
+}
+
+bool TaskScheduler::schedule(TaskGraph& graph, void* context)
+{
+    if (graph.isRunning())
+    {
+        CK_LOG_ERROR("TaskScheduler", "Task graph is already running!");
+        return false;
+    }
+    if (!graph.prepare())
+        return false;
+
+    //  the graph's node count is captured up front, since nodes may finish
+    //  (and the graph with them) as roots are scheduled
+    const uint32_t nodeCount = graph.size();
+    for (TaskGraph::NodeIndex i = 0; i < nodeCount; ++i)
+    {
+        if (!graph._nodes[i].predecessorCount)
+            scheduleGraphNode(graph, i, context);
+    }
+    return true;
+}
+
+void TaskScheduler::scheduleGraphNode
+(
+    TaskGraph& graph,
+    TaskGraph::NodeIndex index,
+    void* context
+)
+{
+    Task* task = graph._nodes[index].task.get();
+    TaskId handle = attach(task, context);
+    if (!handle)
+    {
+        finishGraphNode(graph, index, false, context);
+        return;
+    }
+    TaskSlot& slot = _slots[handle & kSlotIndexMask];
+    slot.graph = &graph;
+    slot.graphNode = index;
+    enqueue(task);
+}
+
+void TaskScheduler::finishGraphNode
+(
+    TaskGraph& graph,
+    TaskGraph::NodeIndex index,
+    bool ended,
+    void* context
+)
+{
+    TaskGraph::Node& node = graph._nodes[index];
+    if (!ended)
+        graph._failed = true;
+
+    for (uint32_t s = 0; s < node.successorCount; ++s)
+    {
+        TaskGraph::NodeIndex successorIndex =
+            graph._successors[node.firstSuccessor + s];
+        TaskGraph::Node& successor = graph._nodes[successorIndex];
+        if (!ended)
+            successor.skip = true;
+        if (!--successor.pending)
+        {
+            //  successors of a failed task are skipped, along with their
+            //  own successors
+            if (successor.skip)
+                finishGraphNode(graph, successorIndex, false, context);
+            else
+                scheduleGraphNode(graph, successorIndex, context);
+        }
+    }
 
-    return _currentHandle;
+    --graph._remaining;
+}
+
+Task* TaskScheduler::findTask(TaskId taskHandle) const
+{
+    uint32_t index = taskHandle & kSlotIndexMask;
+    if (index >= _slots.size())
+        return nullptr;
+    const TaskSlot& slot = _slots[index];
+    if (slot.generation != (taskHandle >> kSlotIndexBits))
+        return nullptr;
+    return slot.task;
+}
+
+void TaskScheduler::releaseSlot(TaskId taskHandle)
+{
+    uint32_t index = taskHandle & kSlotIndexMask;
+    TaskSlot& slot = _slots[index];
+    //  invalidates outstanding handles to this slot.  generation zero is
+    //  skipped so that a valid handle is never zero
+    slot.generation = (slot.generation + 1) & kSlotGenerationMask;
+    if (!slot.generation)
+        slot.generation = 1;
+    unlinkContext(slot.task);
+    slot.task = nullptr;
+    slot.owner = nullptr;
+    slot.graph = nullptr;
+    slot.nextFree = kNullSlot;
+    if (_freeTail != kNullSlot)
+        _slots[_freeTail].nextFree = index;
+    else
+        _freeHead = index;
+    _freeTail = index;
+}
+
+void TaskScheduler::enqueue(Task* task)
+{
+    //  a newly runnable task counts as having run this update so that it
+    //  isn't considered starved the moment it's deferred
+    task->_lastRunFrame = _frame;
+    if (task->_parallelSafe)
+        _parallelList.push_back(task);
+    else
+        _runLists[(size_t)task->_priority].push_back(task);
+}
+
+void TaskScheduler::wake(Task* task)
+{
+    if (TaskTimerWheel::contains(task))
+    {
+        _timerWheel.remove(task);
+        enqueue(task);
+    }
 }
 
 void TaskScheduler::cancel(TaskId taskHandle)
 {
-    auto it = std::lower_bound(_tasks.begin(), _tasks.end(), taskHandle);
-    if (it == _tasks.end() || (*it).get()->id() != taskHandle)
+    Task* task = findTask(taskHandle);
+    if (!task)
         return;
 
-    (*it).get()->cancel();
+    task->cancel();
+    //  dormant tasks are woken so that cancellation is handled on the next
+    //  update
+    wake(task);
 }
 
 bool TaskScheduler::isActive(TaskId taskHandle)
 {
-    auto it = std::lower_bound(_tasks.begin(), _tasks.end(), taskHandle);
-    if (it == _tasks.end() || (*it).get()->id() != taskHandle)
-        return false;
-    
-    return true;
+    return findTask(taskHandle) != nullptr;
+}
+
+void TaskScheduler::cancelMany(const TaskId* taskHandles, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        cancel(taskHandles[i]);
+    }
 }
 
 void TaskScheduler::cancelAll(void* context)
 {
-    for (auto& tp : _tasks)
+    if (!context)
     {
-        if (!context || tp->_schedulerContext == context) {
-            tp->cancel();
+        for (auto& slot : _slots)
+        {
+            Task* task = slot.task;
+            if (task) {
+                task->cancel();
+                wake(task);
+            }
         }
+        return;
+    }
+
+    const ContextEntry& entry = _contextTable[findContextEntry(context)];
+    if (!entry.context)
+        return;
+
+    //  canceled tasks remain linked until they're released by update()
+    for (Task* task = entry.head; task; task = task->_contextNext)
+    {
+        task->cancel();
+        wake(task);
     }
 }
 
-void TaskScheduler::update(uint32_t deltaTimeMs)
+void TaskScheduler::linkContext(Task* task)
 {
-    auto taskIt = _runList.begin();
+    task->_contextPrev = nullptr;
+    task->_contextNext = nullptr;
+    if (!task->_schedulerContext)
+        return;
 
-    while (taskIt != _runList.end())
+    if ((_contextCount + 1) * 2 > _contextTable.size())
+        growContextTable();
+
+    ContextEntry& entry = _contextTable[findContextEntry(task->_schedulerContext)];
+    if (entry.context)
+    {
+        entry.head->_contextPrev = task;
+        task->_contextNext = entry.head;
+    }
+    else
     {
-        Task* task = static_cast<Task*>(taskIt.ptr());
+        entry.context = task->_schedulerContext;
+        ++_contextCount;
+    }
+    entry.head = task;
+}
 
-        CK_ASSERT(task->_state != Task::State::kIdle);
+void TaskScheduler::unlinkContext(Task* task)
+{
+    if (!task->_schedulerContext)
+        return;
 
-        // remember, task actions (begin, end, etc) can alter the task's state
-        // so set our default state prior to executing the action when necessary
-        // for example, onBegin may call fail(), which should set the task state
-        // to fail, overwriting our default 'active' state
-        if (task->_state == Task::State::kStaged)
+    if (task->_contextNext)
+        task->_contextNext->_contextPrev = task->_contextPrev;
+    if (task->_contextPrev)
+    {
+        task->_contextPrev->_contextNext = task->_contextNext;
+    }
+    else if (task->_contextNext)
+    {
+        _contextTable[findContextEntry(task->_schedulerContext)].head =
+            task->_contextNext;
+    }
+    else
+    {
+        eraseContextEntry(findContextEntry(task->_schedulerContext));
+    }
+    task->_contextPrev = nullptr;
+    task->_contextNext = nullptr;
+}
+
+namespace {
+
+uint32_t contextHash(void* context, uint32_t mask)
+{
+    //  Fibonacci hashing spreads the low bits lost to pointer alignment
+    uint64_t key = (uint64_t)(uintptr_t)context;
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+} /* anonymous namespace */
+
+uint32_t TaskScheduler::findContextEntry(void* context) const
+{
+    //  the table is never full, so probing ends at the context's entry or
+    //  at the empty entry where it would be inserted
+    const uint32_t mask = (uint32_t)_contextTable.size() - 1;
+    uint32_t index = contextHash(context, mask);
+    while (_contextTable[index].context &&
+           _contextTable[index].context != context)
+    {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void TaskScheduler::eraseContextEntry(uint32_t index)
+{
+    //  shift later entries of the probe sequence back into the hole, so
+    //  lookups never need to probe past removed entries
+    const uint32_t mask = (uint32_t)_contextTable.size() - 1;
+    uint32_t hole = index;
+    for (uint32_t next = (hole + 1) & mask;
+         _contextTable[next].context;
+         next = (next + 1) & mask)
+    {
+        uint32_t home = contextHash(_contextTable[next].context, mask);
+        if (((next - home) & mask) >= ((next - hole) & mask))
         {
-            task->_state = Task::State::kActive;
-            task->onBegin();
+            _contextTable[hole] = _contextTable[next];
+            hole = next;
         }
-        if (task->_state == Task::State::kActive)
+    }
+    _contextTable[hole] = ContextEntry { nullptr, nullptr };
+    --_contextCount;
+}
+
+void TaskScheduler::growContextTable()
+{
+    vector<ContextEntry> oldTable(_contextTable.get_allocator());
+    oldTable.swap(_contextTable);
+    _contextTable.resize(oldTable.size() * 2, ContextEntry { nullptr, nullptr });
+    for (const ContextEntry& entry : oldTable)
+    {
+        if (entry.context)
+            _contextTable[findContextEntry(entry.context)] = entry;
+    }
+}
+
+void TaskScheduler::update(uint32_t deltaTimeMs, uint32_t budgetUs)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto startTime = Clock::now();
+    auto elapsedUs = [startTime]() -> uint64_t {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - startTime).count();
+    };
+
+    ++_frame;
+    if (_tracer)
+        _tracer->beginFrame();
+    const uint64_t totalDeferredCount = _stats.totalDeferredCount;
+    _stats = UpdateStats();
+    _stats.totalDeferredCount = totalDeferredCount;
+
+    drainSubmissions();
+
+    //  tasks woken by the timer are sorted into their priority's run list
+    _timerWheel.advance(deltaTimeMs, _wokenList);
+    while (!_wokenList.empty())
+    {
+        Task* task = static_cast<Task*>(&_wokenList.front());
+        _wokenList.pop_front();
+        enqueue(task);
+    }
+    const uint64_t now = _timerWheel.time();
+
+    updateParallelTasks(deltaTimeMs, now);
+
+    bool budgetExhausted = false;
+
+    for (size_t priority = 0; priority < (size_t)Task::Priority::kCount; ++priority)
+    {
+        const bool critical = priority == (size_t)Task::Priority::kCritical;
+        RunList& runList = _runLists[priority];
+        auto firstDeferredIt = runList.end();
+        auto taskIt = runList.begin();
+
+        while (taskIt != runList.end())
         {
-            task->onUpdate(deltaTimeMs);
+            Task* task = static_cast<Task*>(taskIt.ptr());
+
+            if (!critical && budgetUs && !budgetExhausted)
+            {
+                budgetExhausted = elapsedUs() >= budgetUs;
+            }
+            if (!critical && budgetExhausted)
+            {
+                //  once the budget's spent, only tasks deferred for too
+                //  many consecutive updates are run
+                if (_frame - task->_lastRunFrame <= _starvationLimit)
+                {
+                    if (firstDeferredIt == runList.end())
+                        firstDeferredIt = taskIt;
+                    ++_stats.deferredCount[priority];
+                    ++taskIt;
+                    continue;
+                }
+                ++_stats.starvedRunCount;
+            }
+
+            ++_stats.runCount[priority];
+            task->_lastRunFrame = _frame;
+            taskIt = runTask(runList, taskIt, deltaTimeMs, now);
         }
 
-        bool killState = true;
-        switch (task->_state)
+        //  rotate tasks that ran ahead of the deferred tasks to the back of
+        //  the list, so that deferred tasks run first next update
+        if (firstDeferredIt != runList.end())
         {
-        case Task::State::kEnded:
+            while (runList.begin() != firstDeferredIt)
             {
-                //  advance to next task in the chain
-                task->onEnd();
-                auto nextTask = std::move(task->_nextTask);
-                if (nextTask)
+                Task* task = static_cast<Task*>(&runList.front());
+                runList.pop_front();
+                runList.push_back(task);
+            }
+        }
+
+        _stats.totalDeferredCount += _stats.deferredCount[priority];
+    }
+
+    _stats.updateTimeUs = (uint32_t)elapsedUs();
+    if (_tracer)
+        _tracer->endFrame();
+}
+
+void TaskScheduler::updateParallelTasks(uint32_t deltaTimeMs, uint64_t now)
+{
+    if (_parallelList.empty())
+        return;
+
+    //  callbacks other than onUpdate run here on the updating thread
+    _parallelBatch.clear();
+    for (auto& node : _parallelList)
+    {
+        Task* task = static_cast<Task*>(&node);
+        uint32_t taskDeltaMs = beginTask(task, deltaTimeMs, now);
+        if (task->_state == Task::State::kActive)
+        {
+            _parallelBatch.push_back({ task, taskDeltaMs });
+        }
+    }
+
+    ParallelEntry* entries = _parallelBatch.data();
+    const uint32_t entryCount = (uint32_t)_parallelBatch.size();
+    if (_jobSystem && entryCount > 1)
+    {
+        //  several batches per worker so that workers finishing early can
+        //  steal the remainder
+        uint32_t batchCount = std::min(entryCount, _jobSystem->workerCount() * 4);
+        uint32_t batchSize = (entryCount + batchCount - 1) / batchCount;
+        JobCounter counter;
+        for (uint32_t first = 0; first < entryCount; first += batchSize)
+        {
+            uint32_t last = std::min(first + batchSize, entryCount);
+            TaskTracer* tracer = _tracer;
+            _jobSystem->run([entries, first, last, tracer]() {
+                for (uint32_t i = first; i < last; ++i)
                 {
-                    schedule(std::move(nextTask));
+                    Task* task = entries[i].task;
+                    TaskTracer::Scope trace(tracer, *task, TaskTracer::kUpdate);
+                    task->onUpdate(entries[i].deltaTimeMs);
                 }
-            }
-            break;
-        case Task::State::kFailed:
+            }, &counter);
+        }
+        _jobSystem->wait(counter);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < entryCount; ++i)
+        {
+            Task* task = entries[i].task;
+            TaskTracer::Scope trace(_tracer, *task, TaskTracer::kUpdate);
+            task->onUpdate(entries[i].deltaTimeMs);
+        }
+    }
+    _stats.parallelRunCount = entryCount;
+
+    auto taskIt = _parallelList.begin();
+    while (taskIt != _parallelList.end())
+    {
+        taskIt = completeTask(_parallelList, taskIt, now);
+    }
+}
+
+TaskScheduler::RunList::iterator TaskScheduler::runTask
+(
+    RunList& runList,
+    RunList::iterator taskIt,
+    uint32_t deltaTimeMs,
+    uint64_t now
+)
+{
+    Task* task = static_cast<Task*>(taskIt.ptr());
+    uint32_t taskDeltaMs = beginTask(task, deltaTimeMs, now);
+    if (task->_state == Task::State::kActive)
+    {
+        TaskTracer::Scope trace(_tracer, *task, TaskTracer::kUpdate);
+        task->onUpdate(taskDeltaMs);
+    }
+    return completeTask(runList, taskIt, now);
+}
+
+uint32_t TaskScheduler::beginTask
+(
+    Task* task,
+    uint32_t deltaTimeMs,
+    uint64_t now
+)
+{
+    CK_ASSERT(task->_state != Task::State::kIdle);
+
+    //  a woken task's delta spans the time it was dormant
+    uint32_t taskDeltaMs = deltaTimeMs;
+    if (task->_timerSlot == Task::kTimerSlotExpired)
+    {
+        taskDeltaMs = (uint32_t)(now - task->_timerStart);
+        task->_timerSlot = Task::kTimerSlotNone;
+    }
+
+    // remember, task actions (begin, end, etc) can alter the task's state
+    // so set our default state prior to executing the action when necessary
+    // for example, onBegin may call fail(), which should set the task state
+    // to fail, overwriting our default 'active' state
+    if (task->_state == Task::State::kStaged)
+    {
+        task->_state = Task::State::kActive;
+        TaskTracer::Scope trace(_tracer, *task, TaskTracer::kBegin);
+        task->onBegin();
+    }
+    return taskDeltaMs;
+}
+
+TaskScheduler::RunList::iterator TaskScheduler::completeTask
+(
+    RunList& runList,
+    RunList::iterator taskIt,
+    uint64_t now
+)
+{
+    Task* task = static_cast<Task*>(taskIt.ptr());
+
+    bool killState = true;
+    switch (task->_state)
+    {
+    case Task::State::kEnded:
+        {
+            //  advance to next task in the chain
             {
-                task->onFail();
+                TaskTracer::Scope trace(_tracer, *task, TaskTracer::kEnd);
+                task->onEnd();
             }
-            break;
-        case Task::State::kCanceled:
+            auto nextTask = std::move(task->_nextTask);
+            if (nextTask)
             {
-                task->onCancel();
+                schedule(std::move(nextTask));
             }
-            break;
-        default:
-            killState = false;
-            break;
-        }
-
-        if (killState)
-        {
-            auto thisTaskIt = taskIt;
-            ++taskIt;
-            //  remove task from the run list FIRST and then the task store,
-            //  where removing from the task store destroys the task itself
-            auto handle = task->_schedulerHandle;
-            _runList.erase(thisTaskIt);
-            //  the task must be within the task list at this point.   if not,
-            //  something very wrong has happened with our task lifecycle
-            //  assumptions.
-            auto it = std::lower_bound(_tasks.begin(), _tasks.end(), handle);
-            CK_ASSERT(it != _tasks.end() && (*it).get()->id() == handle);
-            _tasks.erase(it);
+        }
+        break;
+    case Task::State::kFailed:
+        {
+            TaskTracer::Scope trace(_tracer, *task, TaskTracer::kFail);
+            task->onFail();
+        }
+        break;
+    case Task::State::kCanceled:
+        {
+            TaskTracer::Scope trace(_tracer, *task, TaskTracer::kCancel);
+            task->onCancel();
+        }
+        break;
+    default:
+        killState = false;
+        break;
+    }
+
+    if (!killState && (task->_sleepMs || task->_periodMs))
+    {
+        //  an explicit sleep takes precedence over the task's period.
+        //  periodic tasks keep their cadence relative to their prior
+        //  wake time, unless they've fallen behind by a whole period
+        uint64_t expiry;
+        if (task->_sleepMs)
+        {
+            expiry = now + task->_sleepMs;
+            task->_sleepMs = 0;
         }
         else
         {
-            ++taskIt;
+            expiry = task->_timerExpiry + task->_periodMs;
+            if (expiry <= now)
+                expiry = now + task->_periodMs;
         }
+        taskIt = runList.erase(taskIt);
+        task->_timerStart = now;
+        _timerWheel.insert(task, expiry);
+        return taskIt;
     }
+
+    if (killState)
+    {
+        //  remove task from the run list FIRST and then the task store,
+        //  where releasing the task's slot destroys the task itself
+        auto handle = task->_schedulerHandle;
+        //  successors of a graph's task are appended to their run lists
+        //  before this task is removed, so that those sharing this task's
+        //  run list are updated in this pass
+        TaskSlot& slot = _slots[handle & kSlotIndexMask];
+        if (slot.graph)
+        {
+            finishGraphNode(*slot.graph, slot.graphNode,
+                            task->_state == Task::State::kEnded,
+                            task->_schedulerContext);
+        }
+        taskIt = runList.erase(taskIt);
+        //  the task must be within the task store at this point.   if
+        //  not, something very wrong has happened with our task lifecycle
+        //  assumptions.
+        CK_ASSERT(findTask(handle) == task);
+        releaseSlot(handle);
+        return taskIt;
+    }
+
+    return ++taskIt;
 }
 
 
@@ -32,14 +32,46 @@
 #define CINEK_TASKSCHEDULER_HPP
 
 #include "cinek/task.hpp"
+#include "cinek/taskgraph.hpp"
 #include "cinek/vector.hpp"
+#include "cinek/map.hpp"
 #include "cinek/intrusive_list.hpp"
+#include "cinek/mpsc_queue.hpp"
+#include "cinek/slaballocator.hpp"
+#include "cinek/tasktimerwheel.hpp"
 
 namespace cinek {
 
+    class JobSystem;
+    class TaskTracer;
+
     /**
      *  @class  TaskScheduler
      *  @brief  Manages cooperative execution and the lifecycle of tasks.
+     *
+     *  Scheduled tasks are stored in a generational slot map.  A TaskId
+     *  encodes the task's slot index and the slot's generation at the time
+     *  the task was scheduled, so lookups are O(1) and ids belonging to
+     *  completed tasks are rejected once their slot is reused.
+     *
+     *  Tasks run in order of priority.  An update may be given a time budget,
+     *  and once it's exhausted the remaining non-critical tasks are deferred
+     *  to later updates.  Deferred tasks run first on the following update
+     *  within their priority class, and tasks deferred for too many
+     *  consecutive updates run regardless of the budget.
+     *
+     *  Parallel-safe tasks are updated together, ahead of the other tasks,
+     *  with their onUpdate calls split across a JobSystem's workers when
+     *  one is attached.  Their other callbacks, and any tasks they chain to,
+     *  run on the updating thread in a deterministic order.  Parallel-safe
+     *  tasks are not subject to the update's time budget.
+     *
+     *  Tasks that sleep, or are scheduled with a delay or period, are held
+     *  in a timing wheel and are not touched by update() until they wake.
+     *
+     *  Tasks created with createTask are allocated from a pool owned by the
+     *  scheduler, so that spawning tasks in steady state does not touch the
+     *  general heap.
      */
     class TaskScheduler
     {
@@ -50,10 +82,41 @@ namespace cinek {
          * Constructor
          *
          * @param taskLimit The expected maximum of concurrent tasks running
-         * @param allocator An optional allocator
+         * @param allocator An optional allocator, also backing the task pool
          */
         explicit TaskScheduler(uint32_t taskLimit,
                                const Allocator& allocator=Allocator());
+        ~TaskScheduler();
+        /**
+         * Allocates a task from the scheduler's task pool.  Pooled tasks
+         * (and tasks chained to them using taskAllocator()) must not outlive
+         * the scheduler.  The pool is thread-safe, so tasks may be created
+         * on any thread and handed to scheduleFromAnyThread.
+         *
+         * @param  args Arguments passed to the constructor of T
+         * @return The allocated task, ready to schedule
+         */
+        template<typename T, typename... Args>
+        unique_ptr<Task> createTask(Args&&... args);
+        /**
+         * @return The allocator used by createTask
+         */
+        const Allocator& taskAllocator() const { return _taskAllocator; }
+        /**
+         * Attaches a JobSystem used to update parallel-safe tasks.  If none
+         * is attached, parallel-safe tasks are updated on the calling thread.
+         * update() must be called from the JobSystem's creating thread.
+         *
+         * @param  jobSystem    The JobSystem, or nullptr to detach
+         */
+        void setJobSystem(JobSystem* jobSystem) { _jobSystem = jobSystem; }
+        /**
+         * Attaches a tracer recording the time spent in task callbacks
+         * during each update.
+         *
+         * @param  tracer   The tracer, or nullptr to disable tracing
+         */
+        void setTracer(TaskTracer* tracer) { _tracer = tracer; }
         /**
          * Schedules a Task object for execution.  The scheduler takes ownership
          * of the Task.
@@ -62,15 +125,71 @@ namespace cinek {
          * @return      Handle to the scheduled Task
          */
         TaskId schedule(unique_ptr<Task>&& task, void* context=nullptr);
+        /**
+         * Schedules a Task object from any thread.  The task is handed to
+         * the scheduler through a lock-free queue and is scheduled at the
+         * start of the next update, at which point it receives its handle.
+         * The task must come from a thread-safe allocator, such as
+         * createTask or the default heap.
+         *
+         * @param  task     Task pointer
+         * @param  context  (Optional) Context pointer
+         */
+        void scheduleFromAnyThread(unique_ptr<Task>&& task,
+                                   void* context=nullptr);
+        /**
+         * Schedules a Task object to begin after a delay.  The task is
+         * dormant until then.
+         *
+         * @param  task     Task pointer
+         * @param  delayMs  Milliseconds until the task begins
+         * @param  context  (Optional) Context pointer
+         * @return          Handle to the scheduled Task
+         */
+        TaskId scheduleAfter(unique_ptr<Task>&& task, uint32_t delayMs,
+                             void* context=nullptr);
+        /**
+         * Schedules a Task object updated once per period, until it ends.
+         * The first update occurs after one period.  The task is dormant
+         * between updates, and its onUpdate receives the time elapsed since
+         * its prior update.
+         *
+         * @param  task     Task pointer
+         * @param  periodMs Milliseconds between updates
+         * @param  context  (Optional) Context pointer
+         * @return          Handle to the scheduled Task
+         */
+        TaskId schedulePeriodic(unique_ptr<Task>&& task, uint32_t periodMs,
+                                void* context=nullptr);
+        /**
+         * Schedules a TaskGraph for execution.  Tasks without predecessors
+         * are scheduled immediately, and the remaining tasks are scheduled
+         * as their predecessors end.  The graph retains ownership of its
+         * tasks, and must outlive its run.
+         *
+         * @param  graph    The graph to run, which must not be running
+         * @param  context  (Optional) Context pointer applied to the graph's
+         *                  tasks
+         * @return          False if the graph could not be scheduled
+         */
+        bool schedule(TaskGraph& graph, void* context=nullptr);
         /**
          * Cancels a scheduled task.
          *
          * @param jobHandle Handle to a scheduled Task.
          */
         void cancel(TaskId taskHandle);
+        /**
+         * Cancels several scheduled tasks.  Stale handles are ignored.
+         *
+         * @param taskHandles   Handles to scheduled Tasks
+         * @param count         The number of handles
+         */
+        void cancelMany(const TaskId* taskHandles, size_t count);
         /**
          * Cancels task by a context pointer.  If nullptr is specified, then
-         * all tasks are cancelled.
+         * all tasks are cancelled.  Tasks are indexed by context, so
+         * canceling a context only visits tasks scheduled with it.
          *
          * @param   context The context pointer specified during schedule (if
          *                  any.)
@@ -79,9 +198,37 @@ namespace cinek {
         /**
          * Executes tasks currently scheduled
          *
-         * @param timeMs Delta time in milliseconds since last update
+         * @param timeMs    Delta time in milliseconds since last update
+         * @param budgetUs  Time budget for this update in microseconds.  If
+         *                  zero, all runnable tasks are executed.
          */
-        void update(uint32_t timeMs);
+        void update(uint32_t timeMs, uint32_t budgetUs=0);
+        /**
+         * Sets how many consecutive updates a task may be deferred before it
+         * runs regardless of the time budget.
+         *
+         * @param updateCount   The deferral limit, in updates
+         */
+        void setStarvationLimit(uint32_t updateCount) { _starvationLimit = updateCount; }
+
+        /** Statistics from the most recent update */
+        struct UpdateStats
+        {
+            /** Wall time spent in update, in microseconds */
+            uint32_t updateTimeUs;
+            /** Tasks executed per priority */
+            uint32_t runCount[(size_t)Task::Priority::kCount];
+            /** Tasks deferred per priority */
+            uint32_t deferredCount[(size_t)Task::Priority::kCount];
+            /** Deferred tasks executed past the budget to avoid starvation */
+            uint32_t starvedRunCount;
+            /** Parallel-safe tasks executed */
+            uint32_t parallelRunCount;
+            /** Total deferrals over the scheduler's lifetime */
+            uint64_t totalDeferredCount;
+        };
+        /** @return Statistics from the most recent update */
+        const UpdateStats& stats() const { return _stats; }
         /**
          *  Queries whether a task is currently active by handle.
          *
@@ -89,13 +236,103 @@ namespace cinek {
          *  @return True if the task is still active
          */
         bool isActive(TaskId taskHandle);
+        /**
+         *  @return The scheduler's time in milliseconds, accumulated from
+         *          update() calls
+         */
+        uint64_t time() const { return _timerWheel.time(); }
 
     private:
-        intrusive_list<TaskListNode> _runList;
-        vector<unique_ptr<Task>> _tasks;
-        TaskId _currentHandle;
+        enum : uint32_t
+        {
+            kSlotIndexBits = 20,
+            kSlotIndexMask = (1 << kSlotIndexBits) - 1,
+            kSlotGenerationMask = (1 << (32 - kSlotIndexBits)) - 1,
+            kNullSlot = 0xffffffff
+        };
+
+        struct TaskSlot
+        {
+            Task* task;
+            //  null for tasks owned by a graph
+            unique_ptr<Task> owner;
+            TaskGraph* graph;
+            TaskGraph::NodeIndex graphNode;
+            uint32_t generation;
+            uint32_t nextFree;
+        };
+
+        using RunList = intrusive_list<TaskListNode>;
+
+        TaskId attach(unique_ptr<Task>&& task, void* context);
+        TaskId attach(Task* task, void* context);
+        void scheduleGraphNode(TaskGraph& graph, TaskGraph::NodeIndex index,
+                               void* context);
+        void finishGraphNode(TaskGraph& graph, TaskGraph::NodeIndex index,
+                             bool ended, void* context);
+        void enqueue(Task* task);
+        void wake(Task* task);
+        RunList::iterator runTask(RunList& runList, RunList::iterator taskIt,
+                                  uint32_t deltaTimeMs, uint64_t now);
+        uint32_t beginTask(Task* task, uint32_t deltaTimeMs, uint64_t now);
+        RunList::iterator completeTask(RunList& runList, RunList::iterator taskIt,
+                                       uint64_t now);
+        void updateParallelTasks(uint32_t deltaTimeMs, uint64_t now);
+        void drainSubmissions();
+        void linkContext(Task* task);
+        void unlinkContext(Task* task);
+        uint32_t findContextEntry(void* context) const;
+        void eraseContextEntry(uint32_t index);
+        void growContextTable();
+        Task* findTask(TaskId taskHandle) const;
+        void releaseSlot(TaskId taskHandle);
+
+        SlabAllocator _taskPool;
+        cinek_memory_callbacks _taskPoolCallbacks;
+        Allocator _taskAllocator;
+
+        RunList _runLists[(size_t)Task::Priority::kCount];
+        RunList _wokenList;
+        IntrusiveMPSCQueue<TaskListNode> _submitQueue;
+        RunList _parallelList;
+        //  parallel-safe tasks and their deltas for the current update
+        struct ParallelEntry
+        {
+            Task* task;
+            uint32_t deltaTimeMs;
+        };
+        vector<ParallelEntry> _parallelBatch;
+        JobSystem* _jobSystem;
+        TaskTracer* _tracer;
+        TaskTimerWheel _timerWheel;
+        uint32_t _frame;
+        uint32_t _starvationLimit;
+        UpdateStats _stats;
+        vector<TaskSlot> _slots;
+        //  the first task of each context's list of tasks, in a linear
+        //  probing table kept at most half full.  It's sized from the task
+        //  limit so that linking tasks doesn't allocate until it's exceeded.
+        struct ContextEntry
+        {
+            void* context;
+            Task* head;
+        };
+        vector<ContextEntry> _contextTable;
+        uint32_t _contextCount;
+        //  free slots are recycled in FIFO order to maximize the time before
+        //  a slot's generation wraps
+        uint32_t _freeHead;
+        uint32_t _freeTail;
     };
 
+    ////////////////////////////////////////////////////////////////////////////
+
+    template<typename T, typename... Args>
+    unique_ptr<Task> TaskScheduler::createTask(Args&&... args)
+    {
+        return allocate_unique<T, Task>(_taskAllocator, std::forward<Args>(args)...);
+    }
+
 } /* namespace cinek */
 
 
@@ -0,0 +1,168 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/tasktimerwheel.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A hierarchical timing wheel holding dormant tasks
+ * @copyright Cinekine
+ */
+
+#include "cinek/tasktimerwheel.hpp"
+
+namespace cinek {
+
+TaskTimerWheel::TaskTimerWheel() :
+    _now(0),
+    _count(0)
+{
+}
+
+TaskTimerWheel::~TaskTimerWheel()
+{
+    clear();
+}
+
+bool TaskTimerWheel::contains(const Task* task)
+{
+    return task->_timerSlot < Task::kTimerSlotExpired;
+}
+
+void TaskTimerWheel::insert(Task* task, uint64_t expiry)
+{
+    CK_ASSERT(!contains(task));
+    task->_timerExpiry = expiry;
+    //  the current tick's slot was already processed, so the earliest a
+    //  newly inserted task can wake is the next tick
+    place(task, _now + 1);
+    ++_count;
+}
+
+void TaskTimerWheel::place(Task* task, uint64_t earliest)
+{
+    uint64_t expiry = task->_timerExpiry;
+    if (expiry < earliest)
+        expiry = earliest;
+
+    const uint64_t delta = expiry - _now;
+    uint32_t level = 0;
+    while (level < kLevelCount-1 &&
+           delta >= ((uint64_t)1 << (kSlotBits * (level+1))))
+    {
+        ++level;
+    }
+    if (level == kLevelCount-1)
+    {
+        //  clamp delays beyond the top level's range.  the task cascades
+        //  back into the top level until it's within range
+        const uint64_t range = (uint64_t)1 << (kSlotBits * kLevelCount);
+        if (delta >= range)
+            expiry = _now + range - 1;
+    }
+
+    const uint32_t slot = (uint32_t)(expiry >> (kSlotBits * level)) & kSlotMask;
+    task->_timerSlot = level * kSlotCount + slot;
+    _slots[level][slot].push_back(task);
+}
+
+void TaskTimerWheel::remove(Task* task)
+{
+    CK_ASSERT_RETURN(contains(task));
+    const uint32_t level = task->_timerSlot / kSlotCount;
+    const uint32_t slot = task->_timerSlot % kSlotCount;
+    _slots[level][slot].erase(task);
+    task->_timerSlot = Task::kTimerSlotNone;
+    --_count;
+}
+
+void TaskTimerWheel::cascade(uint32_t level)
+{
+    const uint32_t slot = (uint32_t)(_now >> (kSlotBits * level)) & kSlotMask;
+    auto& list = _slots[level][slot];
+    while (!list.empty())
+    {
+        Task* task = static_cast<Task*>(&list.front());
+        list.pop_front();
+        //  tasks expiring on this tick land in the level zero slot that's
+        //  processed after cascading
+        place(task, _now);
+    }
+}
+
+void TaskTimerWheel::advance(uint32_t deltaMs, intrusive_list<TaskListNode>& woken)
+{
+    if (!_count)
+    {
+        _now += deltaMs;
+        return;
+    }
+
+    while (deltaMs--)
+    {
+        ++_now;
+
+        //  when a level wraps, redistribute the next higher level's current
+        //  slot into the lower levels
+        for (uint32_t level = 1; level < kLevelCount; ++level)
+        {
+            const uint64_t lowerMask = ((uint64_t)1 << (kSlotBits * level)) - 1;
+            if (_now & lowerMask)
+                break;
+            cascade(level);
+        }
+
+        auto& list = _slots[0][_now & kSlotMask];
+        while (!list.empty())
+        {
+            Task* task = static_cast<Task*>(&list.front());
+            list.pop_front();
+            task->_timerSlot = Task::kTimerSlotExpired;
+            woken.push_back(task);
+            --_count;
+        }
+        if (!_count)
+        {
+            _now += deltaMs;
+            break;
+        }
+    }
+}
+
+void TaskTimerWheel::clear()
+{
+    for (auto& level : _slots)
+    {
+        for (auto& list : level)
+        {
+            while (!list.empty())
+            {
+                Task* task = static_cast<Task*>(&list.front());
+                list.pop_front();
+                task->_timerSlot = Task::kTimerSlotNone;
+            }
+        }
+    }
+    _count = 0;
+}
+
+} /* namespace cinek */
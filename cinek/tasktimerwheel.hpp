@@ -0,0 +1,111 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/tasktimerwheel.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A hierarchical timing wheel holding dormant tasks
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_TASK_TIMERWHEEL_HPP
+#define CINEK_TASK_TIMERWHEEL_HPP
+
+#include "cinek/task.hpp"
+#include "cinek/intrusive_list.hpp"
+
+namespace cinek {
+
+    /**
+     *  @class  TaskTimerWheel
+     *  @brief  Holds dormant tasks until their wake time.
+     *
+     *  A four level hierarchical timing wheel with millisecond ticks and 64
+     *  slots per level (after Varghese and Lauck), covering delays of about
+     *  4.6 hours before tasks are recycled through the top level.  Inserting
+     *  and removing a task is O(1), and advancing the wheel only visits the
+     *  slots for elapsed ticks, plus an occasional cascade of one higher
+     *  level slot into the levels below it.
+     *
+     *  While in the wheel, a task is linked through its TaskListNode, so a
+     *  task cannot be in the wheel and a scheduler's run list at once.
+     */
+    class TaskTimerWheel
+    {
+        CK_CLASS_NON_COPYABLE(TaskTimerWheel);
+
+    public:
+        enum
+        {
+            kSlotBits = 6,
+            kSlotCount = 1 << kSlotBits,
+            kSlotMask = kSlotCount - 1,
+            kLevelCount = 4
+        };
+
+        TaskTimerWheel();
+        ~TaskTimerWheel();
+
+        /** @return The wheel's current time in milliseconds */
+        uint64_t time() const { return _now; }
+        /** @return The number of tasks in the wheel */
+        uint32_t size() const { return _count; }
+        /**
+         * Adds a task to the wheel.  The task must not be linked in a list.
+         *
+         * @param task      The task to insert
+         * @param expiry    The absolute wake time.  If not in the future, the
+         *                  task wakes on the next advance.
+         */
+        void insert(Task* task, uint64_t expiry);
+        /**
+         * Removes a task from the wheel before its wake time
+         *
+         * @param task      A task previously inserted into the wheel
+         */
+        void remove(Task* task);
+        /**
+         * Advances the wheel's time, moving woken tasks onto a list.
+         *
+         * @param deltaMs   Milliseconds to advance
+         * @param woken     Receives expired tasks, in order of expiry
+         */
+        void advance(uint32_t deltaMs, intrusive_list<TaskListNode>& woken);
+        /** Unlinks all tasks from the wheel */
+        void clear();
+
+        /** @return True if the task is held by a TaskTimerWheel */
+        static bool contains(const Task* task);
+
+    private:
+        void place(Task* task, uint64_t earliest);
+        void cascade(uint32_t level);
+
+        intrusive_list<TaskListNode> _slots[kLevelCount][kSlotCount];
+        uint64_t _now;
+        uint32_t _count;
+    };
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/tasktracer.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Records task execution timings for profiling
+ * @copyright Cinekine
+ */
+
+#include "cinek/tasktracer.hpp"
+#include "cinek/debug.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <ostream>
+
+namespace cinek {
+
+namespace {
+    //  small sequential ids are friendlier to trace viewers than native
+    //  thread ids
+    std::atomic<uint32_t> s_nextThreadIndex(0);
+
+    uint16_t currentThreadIndex()
+    {
+        static thread_local uint32_t index = s_nextThreadIndex.fetch_add(1);
+        return (uint16_t)index;
+    }
+
+    uint64_t clockNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* kPhaseNames[TaskTracer::kPhaseCount] = {
+        "onBegin", "onUpdate", "onEnd", "onFail", "onCancel"
+    };
+
+    void writeMicros(std::ostream& out, uint64_t ns)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%" PRIu64 ".%03u", ns / 1000,
+                 (unsigned)(ns % 1000));
+        out << buf;
+    }
+
+    void writeJsonString(std::ostream& out, const char* str)
+    {
+        for (; *str; ++str)
+        {
+            const char c = *str;
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+                out << buf;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+    }
+}
+
+TaskTracer::TaskTracer
+(
+    const InitParams& params,
+    const Allocator& allocator
+) :
+    _eventsPerFrame(params.eventsPerFrame),
+    _events(allocator),
+    _frames(allocator),
+    _frameNumber(0),
+    _frameEventCount(0),
+    _droppedEventCount(0),
+    _epochNs(clockNs()),
+    _classStats(allocator),
+    _classNames(allocator)
+{
+    CK_ASSERT(params.frameLimit > 0);
+    _frames.resize(std::max(params.frameLimit, 1U));
+    _events.resize((size_t)_frames.size() * _eventsPerFrame);
+}
+
+void TaskTracer::setClassName(const TaskClassId& classId, const char* name)
+{
+    _classNames[classId] = name;
+}
+
+uint64_t TaskTracer::now() const
+{
+    return clockNs() - _epochNs;
+}
+
+auto TaskTracer::frameEvents(uint64_t frameNumber) -> Event*
+{
+    return _events.data() + (frameNumber % _frames.size()) * _eventsPerFrame;
+}
+
+auto TaskTracer::frameEvents(uint64_t frameNumber) const -> const Event*
+{
+    return _events.data() + (frameNumber % _frames.size()) * _eventsPerFrame;
+}
+
+void TaskTracer::beginFrame()
+{
+    Frame& frame = _frames[_frameNumber % _frames.size()];
+    frame.number = _frameNumber;
+    frame.beginNs = now();
+    frame.endNs = frame.beginNs;
+    frame.eventCount = 0;
+    frame.thread = currentThreadIndex();
+    _frameEventCount.store(0, std::memory_order_relaxed);
+}
+
+void TaskTracer::record
+(
+    const Task& task,
+    Phase phase,
+    uint64_t beginNs,
+    uint64_t endNs
+)
+{
+    uint32_t index = _frameEventCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= _eventsPerFrame)
+        return;
+
+    Event& event = frameEvents(_frameNumber)[index];
+    event.classId = task.classId();
+    event.taskId = task.id();
+    event.phase = (uint16_t)phase;
+    event.thread = currentThreadIndex();
+    event.beginNs = beginNs;
+    event.endNs = endNs;
+}
+
+void TaskTracer::endFrame()
+{
+    Frame& frame = _frames[_frameNumber % _frames.size()];
+    frame.endNs = now();
+    uint32_t eventCount = _frameEventCount.load(std::memory_order_relaxed);
+    if (eventCount > _eventsPerFrame)
+    {
+        _droppedEventCount += eventCount - _eventsPerFrame;
+        eventCount = _eventsPerFrame;
+    }
+    frame.eventCount = eventCount;
+
+    //  events from a class are often consecutive, so the prior lookup is
+    //  tried first
+    const Event* events = frameEvents(_frameNumber);
+    ClassStats* stats = nullptr;
+    const TaskClassId* statsClassId = nullptr;
+    for (uint32_t i = 0; i < eventCount; ++i)
+    {
+        const Event& event = events[i];
+        if (!statsClassId || *statsClassId != event.classId)
+        {
+            auto it = _classStats.find(event.classId);
+            if (it == _classStats.end())
+            {
+                it = _classStats.emplace(event.classId, ClassStats()).first;
+            }
+            statsClassId = &it->first;
+            stats = &it->second;
+        }
+        uint64_t durationNs = event.endNs - event.beginNs;
+        ++stats->callCount[event.phase];
+        stats->totalNs[event.phase] += durationNs;
+        stats->maxNs[event.phase] = std::max(stats->maxNs[event.phase], durationNs);
+    }
+
+    ++_frameNumber;
+}
+
+void TaskTracer::exportChromeTrace(std::ostream& out) const
+{
+    const uint64_t frameCount = std::min<uint64_t>(_frameNumber, _frames.size());
+    bool first = true;
+
+    out << "{\"traceEvents\":[";
+    for (uint64_t frameNumber = _frameNumber - frameCount;
+         frameNumber < _frameNumber;
+         ++frameNumber)
+    {
+        const Frame& frame = _frames[frameNumber % _frames.size()];
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"update\",\"cat\":\"TaskScheduler\",\"ph\":\"X\",\"ts\":";
+        writeMicros(out, frame.beginNs);
+        out << ",\"dur\":";
+        writeMicros(out, frame.endNs - frame.beginNs);
+        out << ",\"pid\":1,\"tid\":" << frame.thread
+            << ",\"args\":{\"frame\":" << frame.number << "}}";
+
+        const Event* events = frameEvents(frameNumber);
+        for (uint32_t i = 0; i < frame.eventCount; ++i)
+        {
+            const Event& event = events[i];
+            out << ",\n{\"name\":\"";
+            auto nameIt = _classNames.find(event.classId);
+            if (nameIt != _classNames.end())
+            {
+                writeJsonString(out, nameIt->second);
+            }
+            else
+            {
+                char hex[33];
+                for (size_t b = 0; b < sizeof(event.classId.bytes); ++b)
+                {
+                    snprintf(hex + b*2, 3, "%02x", event.classId.bytes[b]);
+                }
+                out << hex;
+            }
+            out << "\",\"cat\":\"" << kPhaseNames[event.phase]
+                << "\",\"ph\":\"X\",\"ts\":";
+            writeMicros(out, event.beginNs);
+            out << ",\"dur\":";
+            writeMicros(out, event.endNs - event.beginNs);
+            out << ",\"pid\":1,\"tid\":" << event.thread
+                << ",\"args\":{\"task\":" << event.taskId << "}}";
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+} /* namespace cinek */
@@ -0,0 +1,196 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/tasktracer.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Records task execution timings for profiling
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_TASK_TRACER_HPP
+#define CINEK_TASK_TRACER_HPP
+
+#include "cinek/task.hpp"
+#include "cinek/vector.hpp"
+#include "cinek/map.hpp"
+
+#include <atomic>
+#include <iosfwd>
+
+namespace cinek {
+
+    /**
+     *  @class  TaskTracer
+     *  @brief  Records the time spent in each Task callback per update
+     *
+     *  A tracer attached to a TaskScheduler records the begin and end times
+     *  of every task callback, keyed by the task's classId().  Events are
+     *  kept for a fixed number of recent updates in a ring buffer, and are
+     *  aggregated into per-class statistics as each update finishes.
+     *
+     *  Recorded updates can be exported in the Chrome trace event format,
+     *  readable by chrome://tracing and Perfetto.
+     *
+     *  A scheduler without a tracer pays only a null check per callback.
+     */
+    class TaskTracer
+    {
+        CK_CLASS_NON_COPYABLE(TaskTracer);
+
+    public:
+        /** The traced task callbacks */
+        enum Phase
+        {
+            kBegin,
+            kUpdate,
+            kEnd,
+            kFail,
+            kCancel,
+            kPhaseCount
+        };
+
+        /** Timings aggregated for a task class */
+        struct ClassStats
+        {
+            uint32_t callCount[kPhaseCount];
+            uint64_t totalNs[kPhaseCount];
+            uint64_t maxNs[kPhaseCount];
+        };
+
+        struct InitParams
+        {
+            /** The number of recent updates retained */
+            uint32_t frameLimit;
+            /** Events recorded per update; the excess are dropped */
+            uint32_t eventsPerFrame;
+        };
+
+        /**
+         *  Constructor
+         *
+         *  @param  params      Initialization parameters
+         *  @param  allocator   An optional allocator
+         */
+        TaskTracer(const InitParams& params,
+                   const Allocator& allocator=Allocator());
+        /**
+         *  Assigns a readable name to a task class, used when exporting.
+         *
+         *  @param  classId     The task class
+         *  @param  name        A string that must outlive the tracer
+         */
+        void setClassName(const TaskClassId& classId, const char* name);
+        /** @return Statistics for all task classes recorded */
+        const map<TaskClassId, ClassStats>& classStats() const { return _classStats; }
+        /** Clears aggregated statistics */
+        void resetStats() { _classStats.clear(); }
+        /** @return The number of events dropped due to the per-update limit */
+        uint64_t droppedEventCount() const { return _droppedEventCount; }
+        /**
+         *  Writes recorded updates, oldest first, in the Chrome trace event
+         *  JSON format.
+         *
+         *  @param  out     The output stream
+         */
+        void exportChromeTrace(std::ostream& out) const;
+
+        /** Marks the start of a scheduler update */
+        void beginFrame();
+        /** Marks the end of a scheduler update, aggregating its events */
+        void endFrame();
+        /**
+         *  Records a callback.  Safe to call from multiple threads between
+         *  beginFrame and endFrame.
+         *
+         *  @param  task    The task
+         *  @param  phase   The callback executed
+         *  @param  beginNs The callback's start time from now()
+         *  @param  endNs   The callback's end time from now()
+         */
+        void record(const Task& task, Phase phase, uint64_t beginNs,
+                    uint64_t endNs);
+        /** @return Nanoseconds elapsed since the tracer was created */
+        uint64_t now() const;
+
+        /** Records a task callback for the duration of its scope */
+        class Scope
+        {
+        public:
+            Scope(TaskTracer* tracer, const Task& task, Phase phase) :
+                _tracer(tracer),
+                _task(task),
+                _phase(phase),
+                _beginNs(tracer ? tracer->now() : 0)
+            {
+            }
+            ~Scope()
+            {
+                if (_tracer)
+                    _tracer->record(_task, _phase, _beginNs, _tracer->now());
+            }
+
+        private:
+            TaskTracer* _tracer;
+            const Task& _task;
+            Phase _phase;
+            uint64_t _beginNs;
+        };
+
+    private:
+        struct Event
+        {
+            TaskClassId classId;
+            TaskId taskId;
+            uint16_t phase;
+            uint16_t thread;
+            uint64_t beginNs;
+            uint64_t endNs;
+        };
+
+        struct Frame
+        {
+            uint64_t number;
+            uint64_t beginNs;
+            uint64_t endNs;
+            uint32_t eventCount;
+            uint16_t thread;
+        };
+
+        Event* frameEvents(uint64_t frameNumber);
+        const Event* frameEvents(uint64_t frameNumber) const;
+
+        uint32_t _eventsPerFrame;
+        vector<Event> _events;
+        vector<Frame> _frames;
+        uint64_t _frameNumber;
+        std::atomic<uint32_t> _frameEventCount;
+        uint64_t _droppedEventCount;
+        uint64_t _epochNs;
+        map<TaskClassId, ClassStats> _classStats;
+        map<TaskClassId, const char*> _classNames;
+    };
+
+} /* namespace cinek */
+
+#endif
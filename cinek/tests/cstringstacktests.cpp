@@ -2,6 +2,8 @@
 
 #include "cinek/cstringstack.hpp"
 
+#include <cstring>
+
 using namespace cinek;
 
 static const char* kTinyString = "Test";
@@ -0,0 +1,949 @@
+#include "catch.hpp"
+
+#include "ckentity/entitystore.hpp"
+#include "ckentity/componenttable.hpp"
+#include "ckentity/archetypestore.hpp"
+#include "ckentity/entitycommandbuffer.hpp"
+#include "ckentity/entitysnapshot.hpp"
+#include "ckentity/transformhierarchy.hpp"
+#include "cinek/jobsystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace cinek;
+
+namespace {
+
+    struct Position
+    {
+        float x, y;
+        Position() : x(0), y(0) {}
+        Position(float x_, float y_) : x(x_), y(y_) {}
+    };
+
+}
+
+TEST_CASE("entity stores create and recycle ids in bulk", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 16384;
+    params.recycleDelay = 256;
+    EntityStore store(params);
+
+    SECTION("batches")
+    {
+        vector<Entity> entities(10000);
+        REQUIRE(store.createBatch(10000, 2, entities.data()) == 10000);
+
+        EntityDiagnostics diagnostics;
+        store.diagnostics(diagnostics);
+        REQUIRE(diagnostics.entityCount == 10000);
+        for (Entity e : entities)
+        {
+            REQUIRE(store.valid(e));
+            REQUIRE(cinek_entity_context(e) == 2);
+        }
+
+        store.destroyBatch(entities.data(), 5000);
+        //  repeated ids are skipped
+        store.destroyBatch(entities.data(), 10);
+        store.diagnostics(diagnostics);
+        REQUIRE(diagnostics.entityCount == 5000);
+        REQUIRE_FALSE(store.valid(entities[0]));
+        REQUIRE(store.valid(entities[5000]));
+    }
+
+    SECTION("freed indices are quarantined and recycled in order")
+    {
+        vector<Entity> entities(300);
+        store.createBatch(300, 0, entities.data());
+        store.destroyBatch(entities.data(), 300);
+
+        //  the oldest 44 freed indices are reusable, in the order freed
+        vector<Entity> recycled(50);
+        REQUIRE(store.createBatch(50, 0, recycled.data()) == 50);
+        for (uint32_t i = 0; i < 44; ++i)
+        {
+            REQUIRE(cinek_entity_index(recycled[i]) == cinek_entity_index(entities[i]));
+            REQUIRE(recycled[i] != entities[i]);
+        }
+        for (uint32_t i = 44; i < 50; ++i)
+            REQUIRE(cinek_entity_index(recycled[i]) >= 300);
+    }
+
+    SECTION("deferred destruction waits for gc")
+    {
+        Entity a = store.create();
+        Entity b = store.create();
+        store.destroyDeferred(a);
+        store.destroyDeferred(a);
+        REQUIRE(store.valid(a));
+        store.gc();
+        REQUIRE_FALSE(store.valid(a));
+        REQUIRE(store.valid(b));
+
+        EntityDiagnostics diagnostics;
+        store.diagnostics(diagnostics);
+        REQUIRE(diagnostics.entityCount == 1);
+    }
+}
+
+TEST_CASE("entity iterations wrap within the id's iteration field", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 16;
+    params.recycleDelay = 0;
+    EntityStore store(params);
+
+    //  recycle one index past the iteration field's range - ids must
+    //  never become null, and must stay valid with a nonzero context
+    const uint32_t kIterationLimit =
+        (uint32_t)(kCKEntityIterationMask >> kCKEntityIterationShift);
+    const uint32_t kCycles = kIterationLimit + 16;
+
+    Entity first = store.create(3);
+    Entity eid = first;
+    for (uint32_t cycle = 0; cycle < kCycles; ++cycle)
+    {
+        store.destroy(eid);
+        REQUIRE_FALSE(store.valid(eid));
+        eid = store.create(3);
+        REQUIRE(eid != 0);
+        REQUIRE(cinek_entity_index(eid) == cinek_entity_index(first));
+        REQUIRE(cinek_entity_iteration(eid) != 0);
+        REQUIRE(store.valid(eid));
+    }
+
+    EntityDiagnostics diagnostics;
+    store.diagnostics(diagnostics);
+    REQUIRE(diagnostics.entityCount == 1);
+}
+
+TEST_CASE("entity ids are reserved concurrently", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 16384;
+    params.recycleDelay = 100;
+    EntityStore store(params);
+
+    //  seed the free FIFO so that reservations draw from both paths
+    vector<Entity> seeded(3000);
+    store.createBatch(3000, 0, seeded.data());
+    store.destroyBatch(seeded.data(), 3000);
+
+    const uint32_t kThreadCount = 4;
+    const uint32_t kPerThread = 5000;
+    std::vector<std::vector<Entity>> reserved(kThreadCount);
+    std::atomic<bool> allValid(true);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            auto& out = reserved[t];
+            out.resize(kPerThread);
+            uint32_t count = 0;
+            while (count < kPerThread)
+            {
+                uint32_t batch = 1 + (count % 7);
+                if (batch > kPerThread - count)
+                    batch = kPerThread - count;
+                uint32_t got = batch == 1
+                    ? (out[count] = store.reserve(1)) != 0
+                    : store.reserveBatch(batch, 1, &out[count]);
+                for (uint32_t i = count; i < count + got; ++i)
+                    if (!store.valid(out[i]))
+                        allValid = false;
+                count += got;
+                if (got < batch)
+                    break;
+            }
+            out.resize(count);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(allValid);
+
+    std::vector<Entity> all;
+    for (auto& out : reserved)
+        all.insert(all.end(), out.begin(), out.end());
+    //  the seeded capacity less the quarantined indices
+    REQUIRE(all.size() == 16384 - 100);
+
+    std::sort(all.begin(), all.end(), [](Entity l, Entity r) {
+        return cinek_entity_index(l) < cinek_entity_index(r);
+    });
+    auto duplicate = std::adjacent_find(all.begin(), all.end(), [](Entity l, Entity r) {
+        return cinek_entity_index(l) == cinek_entity_index(r);
+    });
+    REQUIRE(duplicate == all.end());
+
+    EntityDiagnostics diagnostics;
+    store.diagnostics(diagnostics);
+    REQUIRE(diagnostics.entityCount == 16384 - 100);
+
+    //  the owning thread grows capacity past the reservations
+    REQUIRE(store.create() != 0);
+}
+
+TEST_CASE("component tables store components densely by entity", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 16384;
+    params.recycleDelay = 0;
+    EntityStore store(params);
+    ComponentTable<Position> positions(64);
+
+    SECTION("add, get and remove")
+    {
+        Entity a = store.create();
+        Entity b = store.create();
+        Entity c = store.create();
+
+        REQUIRE(positions.add(a, 1.0f, 2.0f) != nullptr);
+        REQUIRE(positions.add(b, 3.0f, 4.0f) != nullptr);
+        REQUIRE(positions.add(c, 5.0f, 6.0f) != nullptr);
+        REQUIRE(positions.size() == 3);
+        REQUIRE(positions.has(b));
+        REQUIRE(positions.get(b)->x == 3.0f);
+
+        //  removal moves the last component into the hole
+        REQUIRE(positions.remove(a));
+        REQUIRE_FALSE(positions.remove(a));
+        REQUIRE(positions.size() == 2);
+        REQUIRE(positions.get(a) == nullptr);
+        REQUIRE(positions.entity(0) == c);
+        REQUIRE(positions.get(c)->y == 6.0f);
+        REQUIRE(positions.get(b)->y == 4.0f);
+
+        //  replacing keeps a single component
+        positions.add(b, 7.0f, 8.0f);
+        REQUIRE(positions.size() == 2);
+        REQUIRE(positions.get(b)->x == 7.0f);
+
+        positions.clear();
+        REQUIRE(positions.empty());
+        REQUIRE_FALSE(positions.has(c));
+    }
+
+    SECTION("stale ids do not match recycled indices")
+    {
+        Entity a = store.create();
+        positions.add(a, 1.0f, 1.0f);
+        store.destroy(a);
+        Entity b = store.create();
+        REQUIRE(cinek_entity_index(a) == cinek_entity_index(b));
+
+        REQUIRE(positions.get(b) == nullptr);
+        REQUIRE(positions.get(a) != nullptr);
+
+        positions.add(b, 2.0f, 2.0f);
+        REQUIRE(positions.size() == 1);
+        REQUIRE(positions.get(a) == nullptr);
+        REQUIRE(positions.get(b)->x == 2.0f);
+    }
+
+    SECTION("iteration covers sparse indices in dense order")
+    {
+        vector<Entity> entities;
+        for (int i = 0; i < 10000; ++i)
+            entities.push_back(store.create());
+        for (size_t i = 0; i < entities.size(); i += 7)
+            positions.add(entities[i], (float)i, 0.0f);
+
+        uint32_t count = 0;
+        bool matches = true;
+        positions.forEach([&](Entity eid, Position& p) {
+            matches = matches && entities[(size_t)p.x] == eid;
+            ++count;
+        });
+        REQUIRE(matches);
+        REQUIRE(count == positions.size());
+        REQUIRE(count == (10000 + 6) / 7);
+
+        float sum = 0.0f;
+        for (auto& p : positions)
+            sum += p.x;
+        REQUIRE(sum > 0.0f);
+    }
+}
+
+namespace {
+
+    struct Velocity
+    {
+        float dx, dy;
+    };
+
+    struct Health
+    {
+        int32_t points;
+    };
+
+}
+
+TEST_CASE("archetype stores group entities by component set", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 16384;
+    EntityStore store(params);
+
+    ArchetypeStore::InitParams storeParams;
+    storeParams.entityLimit = 16384;
+    storeParams.archetypeLimit = 16;
+    ArchetypeStore archetypes(storeParams);
+
+    ComponentTypeId positionType = archetypes.registerComponent<Position>();
+    ComponentTypeId velocityType = archetypes.registerComponent<Velocity>();
+    ComponentTypeId healthType = archetypes.registerComponent<Health>();
+    REQUIRE(archetypes.registerComponent<Velocity>() == velocityType);
+    REQUIRE(archetypes.componentType<Health>() == healthType);
+
+    SECTION("components follow entities between archetypes")
+    {
+        Entity e = store.create();
+        archetypes.add(e, Position(1.0f, 2.0f));
+        archetypes.add(e, Velocity { 3.0f, 4.0f });
+        archetypes.add(e, Health { 50 });
+
+        ComponentSignature signature = archetypes.signature(e);
+        REQUIRE(signature.test(positionType));
+        REQUIRE(signature.test(velocityType));
+        REQUIRE(signature.test(healthType));
+
+        REQUIRE(archetypes.remove<Velocity>(e));
+        REQUIRE_FALSE(archetypes.remove<Velocity>(e));
+        REQUIRE(archetypes.get<Velocity>(e) == nullptr);
+        REQUIRE(archetypes.get<Position>(e)->y == 2.0f);
+        REQUIRE(archetypes.get<Health>(e)->points == 50);
+
+        //  the empty archetype, and one per component set visited
+        REQUIRE(archetypes.archetypeCount() == 5);
+
+        archetypes.erase(e);
+        REQUIRE_FALSE(archetypes.contains(e));
+        REQUIRE(archetypes.size() == 0);
+    }
+
+    SECTION("chunks stay packed as entities leave")
+    {
+        vector<Entity> entities;
+        for (int i = 0; i < 5000; ++i)
+        {
+            Entity e = store.create();
+            entities.push_back(e);
+            archetypes.add(e, Position((float)i, 0.0f));
+            archetypes.add(e, Velocity { 1.0f, 0.0f });
+        }
+
+        ComponentSignature moving;
+        moving.set(positionType);
+        moving.set(velocityType);
+
+        uint32_t chunks = 0;
+        uint32_t rows = 0;
+        archetypes.forEachChunk(moving, [&](const ArchetypeStore::Chunk& chunk) {
+            ++chunks;
+            rows += chunk.size();
+        });
+        REQUIRE(rows == 5000);
+        REQUIRE(chunks > 1);
+
+        for (size_t i = 0; i < entities.size(); i += 2)
+            archetypes.erase(entities[i]);
+
+        bool positionsMatch = true;
+        uint32_t count = 0;
+        archetypes.forEach<Position, Velocity>([&](Entity e, Position& p, Velocity& v) {
+            p.x += v.dx;
+            positionsMatch = positionsMatch && entities[(size_t)p.x - 1] == e;
+            ++count;
+        });
+        REQUIRE(count == 2500);
+        REQUIRE(positionsMatch);
+
+        //  whole chunks are released as the archetype shrinks
+        uint32_t archetype = 0;
+        for (uint32_t a = 0; a < archetypes.archetypeCount(); ++a)
+            if (archetypes.archetypeSignature(a) == moving)
+                archetype = a;
+        uint32_t capacity = archetypes.archetypeChunkCapacity(archetype);
+        REQUIRE(archetypes.archetypeChunkCount(archetype) == (2500 + capacity - 1) / capacity);
+        REQUIRE(capacity * (sizeof(Entity) + sizeof(Position) + sizeof(Velocity))
+                <= ArchetypeStore::kChunkSize);
+    }
+}
+
+TEST_CASE("cached queries track archetypes as they appear", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 1024;
+    EntityStore store(params);
+
+    ArchetypeStore::InitParams storeParams;
+    storeParams.entityLimit = 1024;
+    storeParams.archetypeLimit = 16;
+    ArchetypeStore archetypes(storeParams);
+
+    ComponentTypeId positionType = archetypes.registerComponent<Position>();
+    ComponentTypeId velocityType = archetypes.registerComponent<Velocity>();
+    ComponentTypeId healthType = archetypes.registerComponent<Health>();
+
+    SECTION("signature masks")
+    {
+        ComponentSignature signature;
+        signature.set(3);
+        signature.set(70);
+        signature.set(127);
+
+        REQUIRE(ComponentQuery().with(3).with(127).matches(signature));
+        REQUIRE_FALSE(ComponentQuery().with(3).with(4).matches(signature));
+        REQUIRE_FALSE(ComponentQuery().with(3).without(70).matches(signature));
+        REQUIRE(ComponentQuery().without(71).matches(signature));
+        REQUIRE(ComponentQuery().matches(ComponentSignature()));
+        REQUIRE_FALSE(ComponentQuery().with(64).matches(signature));
+    }
+
+    SECTION("with and without")
+    {
+        //  registered before any matching archetype exists
+        ArchetypeStore::QueryId moving = archetypes.registerQuery(
+            ComponentQuery().with(positionType).with(velocityType).without(healthType));
+        REQUIRE(archetypes.registerQuery(
+            ComponentQuery().with(velocityType).with(positionType).without(healthType)) == moving);
+        REQUIRE(archetypes.queryEntityCount(moving) == 0);
+
+        vector<Entity> entities;
+        for (int i = 0; i < 30; ++i)
+        {
+            Entity e = store.create();
+            entities.push_back(e);
+            archetypes.add(e, Position((float)i, 0.0f));
+            if (i % 2)
+                archetypes.add(e, Velocity { 1.0f, 1.0f });
+            if (i % 3 == 0)
+                archetypes.add(e, Health { i });
+        }
+        //  odd and not a multiple of three
+        REQUIRE(archetypes.queryEntityCount(moving) == 10);
+
+        uint32_t visited = 0;
+        bool matching = true;
+        archetypes.forEach<Position, Velocity>(moving, [&](Entity, Position& p, Velocity&) {
+            int i = (int)p.x;
+            matching = matching && (i % 2) && (i % 3);
+            ++visited;
+        });
+        REQUIRE(visited == 10);
+        REQUIRE(matching);
+
+        //  entities enter and leave results as their components change
+        archetypes.remove<Health>(entities[3]);
+        archetypes.add(entities[1], Health { 1 });
+        archetypes.remove<Velocity>(entities[5]);
+        REQUIRE(archetypes.queryEntityCount(moving) == 9);
+    }
+}
+
+namespace {
+
+    struct CommandWorld
+    {
+        EntityStore store;
+        ComponentTable<Position> positions;
+        ComponentTable<Health> healths;
+        vector<Entity> entities;
+
+        CommandWorld() :
+            store(EntityStore::InitParams { 1024, 0 }),
+            positions(64),
+            healths(64),
+            entities(64)
+        {
+            store.createBatch(64, 0, entities.data());
+            for (Entity e : entities)
+                positions.add(e, 0.0f, 0.0f);
+        }
+    };
+
+    //  records commands for 16 chunks of 4 entities, spreading chunks over
+    //  buffers by threadOf, with one thread per buffer
+    void recordChunks(CommandWorld& world, uint32_t (*threadOf)(uint32_t),
+                      vector<Entity>& created)
+    {
+        EntityCommandBuffer b0(world.store, 256), b1(world.store, 256),
+                            b2(world.store, 256), b3(world.store, 256);
+        EntityCommandBuffer* buffers[] = { &b0, &b1, &b2, &b3 };
+        std::atomic<int> invalid(0);
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                EntityCommandBuffer& buffer = *buffers[t];
+                for (uint32_t chunk = 0; chunk < 16; ++chunk)
+                {
+                    if (threadOf(chunk) != t)
+                        continue;
+                    buffer.setSortKey(chunk);
+                    for (uint32_t i = chunk * 4; i < chunk * 4 + 4; ++i)
+                    {
+                        Entity e = world.entities[i];
+                        switch (i % 4)
+                        {
+                        case 0:
+                            buffer.destroy(e);
+                            break;
+                        case 1:
+                            buffer.add(world.healths, e, Health { (int32_t)i });
+                            break;
+                        case 2:
+                            buffer.remove(world.positions, e);
+                            buffer.add(world.healths, e, Health { 1 });
+                            buffer.remove(world.healths, e);
+                            break;
+                        default:
+                            buffer.add(world.positions, e, Position((float)i, 0.0f));
+                            break;
+                        }
+                    }
+                    if (chunk % 8 == 0)
+                    {
+                        Entity spawned = buffer.create();
+                        if (!world.store.valid(spawned))
+                            ++invalid;
+                        buffer.add(world.healths, spawned, Health { 1000 });
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        REQUIRE(invalid == 0);
+
+        ComponentTableBase* tables[] = { &world.positions, &world.healths };
+        EntityCommandBuffer::playback(buffers, 4, tables, 2);
+        REQUIRE(b2.commandCount() == 0);
+
+        for (uint32_t i = 0; i < world.healths.size(); ++i)
+            if (world.healths.data()[i].points == 1000)
+                created.push_back(world.healths.entity(i));
+    }
+
+    uint32_t roundRobin(uint32_t chunk) { return chunk % 4; }
+    uint32_t blocked(uint32_t chunk) { return 3 - chunk / 4; }
+
+}
+
+TEST_CASE("command buffers defer structural changes to playback", "[entity]")
+{
+    CommandWorld first, second;
+    vector<Entity> createdFirst, createdSecond;
+    recordChunks(first, &roundRobin, createdFirst);
+    recordChunks(second, &blocked, createdSecond);
+
+    //  16 destroyed, 16 lost their position
+    REQUIRE(first.positions.size() == 32);
+    REQUIRE(first.healths.size() == 16 + 2);
+    REQUIRE(createdFirst.size() == 2);
+    for (uint32_t i = 0; i < 64; i += 4)
+        REQUIRE_FALSE(first.store.valid(first.entities[i]));
+    REQUIRE(first.positions.get(first.entities[3])->x == 3.0f);
+    REQUIRE(first.healths.get(first.entities[2]) == nullptr);
+
+    //  the same results in the same dense order, however chunks were
+    //  spread across threads
+    REQUIRE(first.positions.size() == second.positions.size());
+    for (uint32_t i = 0; i < first.positions.size(); ++i)
+    {
+        REQUIRE(first.positions.entity(i) == second.positions.entity(i));
+        REQUIRE(first.positions.data()[i].x == second.positions.data()[i].x);
+    }
+    REQUIRE(first.healths.size() == second.healths.size());
+    for (uint32_t i = 0; i < first.healths.size(); ++i)
+    {
+        if (first.healths.data()[i].points == 1000)
+            continue;
+        REQUIRE(first.healths.entity(i) == second.healths.entity(i));
+        REQUIRE(first.healths.data()[i].points == second.healths.data()[i].points);
+    }
+}
+
+TEST_CASE("entity snapshots restore stores and component tables", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 1024;
+    params.recycleDelay = 4;
+
+    EntityStore store(params);
+    ComponentTable<Position> positions(64);
+    ComponentTable<Health> healths(64);
+
+    vector<Entity> entities(100);
+    store.createBatch(100, 3, entities.data());
+    store.destroyBatch(entities.data(), 10);
+    for (uint32_t i = 10; i < 100; ++i)
+    {
+        positions.add(entities[i], (float)i, -(float)i);
+        if (i % 5 == 0)
+            healths.add(entities[i], Health { (int32_t)i });
+    }
+
+    EntitySnapshot saver;
+    saver.registerTable(1, positions);
+    saver.registerTable(2, healths);
+
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    REQUIRE(saver.save(stream, store));
+    std::string image = stream.str();
+    REQUIRE(image.size() % EntitySnapshot::kSectionAlign == 0);
+
+    EntityStore loaded(params);
+    ComponentTable<Position> loadedPositions(0);
+    ComponentTable<Health> loadedHealths(0);
+    EntitySnapshot loader;
+    loader.registerTable(1, loadedPositions);
+    loader.registerTable(2, loadedHealths);
+
+    SECTION("from memory")
+    {
+        std::vector<uint64_t> buffer(image.size() / sizeof(uint64_t));
+        memcpy(buffer.data(), image.data(), image.size());
+        REQUIRE(loader.load(buffer.data(), image.size(), loaded));
+
+        for (uint32_t i = 0; i < 100; ++i)
+            REQUIRE(loaded.valid(entities[i]) == (i >= 10));
+        EntityDiagnostics diagnostics;
+        loaded.diagnostics(diagnostics);
+        REQUIRE(diagnostics.entityCount == 90);
+
+        REQUIRE(loadedPositions.size() == 90);
+        REQUIRE(loadedPositions.get(entities[42])->y == -42.0f);
+        REQUIRE(loadedHealths.size() == 18);
+        REQUIRE(loadedHealths.get(entities[45])->points == 45);
+        REQUIRE(loadedHealths.get(entities[46]) == nullptr);
+
+        //  the free FIFO resumes where the saved store left off
+        //  with four indices held in quarantine
+        vector<Entity> recycled(7);
+        loaded.createBatch(7, 0, recycled.data());
+        REQUIRE(cinek_entity_index(recycled[0]) == cinek_entity_index(entities[0]));
+        REQUIRE(cinek_entity_index(recycled[5]) == cinek_entity_index(entities[5]));
+        REQUIRE(cinek_entity_index(recycled[6]) == 100);
+    }
+
+    SECTION("from a mapped file")
+    {
+        const char* path = "ckentity_snapshot_test.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            REQUIRE(saver.save(out, store));
+        }
+        REQUIRE(loader.loadFile(path, loaded));
+        std::remove(path);
+
+        REQUIRE(loaded.valid(entities[99]));
+        REQUIRE(loadedPositions.get(entities[99])->x == 99.0f);
+    }
+
+    SECTION("invalid images leave the store untouched")
+    {
+        std::vector<uint64_t> buffer(image.size() / sizeof(uint64_t));
+        memcpy(buffer.data(), image.data(), image.size());
+        REQUIRE_FALSE(loader.load(buffer.data(), image.size() - 16, loaded));
+        reinterpret_cast<uint32_t*>(buffer.data())[1] = EntitySnapshot::kVersion + 1;
+        REQUIRE_FALSE(loader.load(buffer.data(), image.size(), loaded));
+
+        //  header words: indexCount at 4, freedCount at 5, tableCount at 7
+        memcpy(buffer.data(), image.data(), image.size());
+        uint32_t* words = reinterpret_cast<uint32_t*>(buffer.data());
+        words[7] = 0x7fffffff;
+        REQUIRE_FALSE(loader.load(buffer.data(), image.size(), loaded));
+
+        memcpy(buffer.data(), image.data(), image.size());
+        const uint32_t indexCount = words[4];
+        REQUIRE(words[5] > 0);
+        size_t freedOffset = 32 + CK_ALIGN_SIZE(indexCount * sizeof(EntityIterationType),
+                                                (size_t)EntitySnapshot::kSectionAlign);
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(buffer.data());
+        EntityIndexType corrupt = indexCount;
+        memcpy(bytes + freedOffset, &corrupt, sizeof(corrupt));
+        REQUIRE_FALSE(loader.load(buffer.data(), image.size(), loaded));
+
+        //  the first table's entities follow the freed indices and its
+        //  table header
+        const size_t entitiesOffset = freedOffset + 16 +
+            CK_ALIGN_SIZE(words[5] * sizeof(EntityIndexType),
+                          (size_t)EntitySnapshot::kSectionAlign);
+        auto corruptEntity = [&](uint32_t row, Entity eid) {
+            memcpy(buffer.data(), image.data(), image.size());
+            memcpy(bytes + entitiesOffset + row * sizeof(Entity), &eid, sizeof(eid));
+            return loader.load(buffer.data(), image.size(), loaded);
+        };
+        REQUIRE(memcmp(image.data() + entitiesOffset, &entities[10], sizeof(Entity)) == 0);
+        //  duplicated, out of range and stale entities
+        REQUIRE_FALSE(corruptEntity(1, entities[10]));
+        REQUIRE_FALSE(corruptEntity(0, cinek_make_entity(1, 3, indexCount)));
+        REQUIRE_FALSE(corruptEntity(0, entities[0]));
+
+        REQUIRE_FALSE(loaded.valid(entities[50]));
+        REQUIRE(loadedPositions.empty());
+    }
+}
+
+TEST_CASE("component tables track changes per tick", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 1024;
+    EntityStore store(params);
+    ComponentTable<Position> positions(256);
+
+    vector<Entity> entities(200);
+    store.createBatch(200, 0, entities.data());
+    for (Entity e : entities)
+        positions.add(e, 0.0f, 0.0f);
+
+    positions.setChangeTracking(true);
+    REQUIRE(positions.changeLogSize() == 0);
+
+    //  a system's first run sees nothing changed since tracking began
+    uint32_t lastRun = positions.markTick();
+    uint32_t visited = positions.changedSince(lastRun, [](Entity, Position&) {});
+    REQUIRE(visited == 0);
+
+    //  reads don't mark, modifications are logged once per tick
+    positions.get(entities[0])->x = 1.0f;
+    positions.modify(entities[1])->x = 1.0f;
+    positions.modify(entities[1])->y = 1.0f;
+    positions.modify(entities[2])->x = 2.0f;
+    REQUIRE(positions.changeLogSize() == 2);
+
+    //  removed components aren't reported, swapped ones keep their tick
+    positions.modify(entities[3]);
+    positions.remove(entities[3]);
+    positions.remove(entities[4]);
+    positions.add(entities[4], 4.0f, 4.0f);
+    positions.remove(entities[4]);
+    positions.add(entities[4], 5.0f, 5.0f);
+
+    vector<Entity> changed;
+    uint32_t since = lastRun;
+    lastRun = positions.markTick();
+    positions.changedSince(since, [&](Entity e, Position&) { changed.push_back(e); });
+    std::sort(changed.begin(), changed.end());
+    REQUIRE(changed.size() == 3);
+    REQUIRE(changed[0] == entities[1]);
+    REQUIRE(changed[1] == entities[2]);
+    REQUIRE(changed[2] == entities[4]);
+    REQUIRE(positions.changeTick(entities[2]) == lastRun);
+    REQUIRE(positions.changeTick(entities[5]) == 0);
+
+    //  the next run only sees what changed after the last
+    positions.modify(entities[2]);
+    positions.modify(entities[150]);
+    changed.clear();
+    since = lastRun;
+    lastRun = positions.markTick();
+    REQUIRE(positions.changedSince(since, [&](Entity e, Position&) {
+        changed.push_back(e);
+    }) == 2);
+
+    //  a consumer with an older tick still sees everything since then,
+    //  including entity 2 just once
+    REQUIRE(positions.changedSince(0, [](Entity, Position&) {}) == 4);
+
+    positions.trimChanges(since);
+    REQUIRE(positions.changeLogSize() == 2);
+}
+
+namespace {
+
+    //  checks each subtree is contiguous and follows its parent
+    bool isTopological(const TransformHierarchy& transforms)
+    {
+        const uint32_t* parents = transforms.parents();
+        const uint32_t* sizes = transforms.subtreeSizes();
+        for (uint32_t i = 0; i < transforms.size(); ++i)
+        {
+            uint32_t p = parents[i];
+            if (p == TransformHierarchy::kNoParent)
+                continue;
+            if (p >= i || i + sizes[i] > p + sizes[p])
+                return false;
+        }
+        return true;
+    }
+
+    bool nearlyEqual(float a, float b)
+    {
+        return a - b < 1e-4f && b - a < 1e-4f;
+    }
+
+}
+
+TEST_CASE("transform hierarchies propagate dirty subtrees", "[entity]")
+{
+    EntityStore::InitParams params;
+    params.numEntities = 1024;
+    EntityStore store(params);
+
+    TransformHierarchy::InitParams hierarchyParams;
+    hierarchyParams.entityLimit = 1024;
+    hierarchyParams.transformLimit = 256;
+    TransformHierarchy transforms(hierarchyParams);
+
+    vector<Entity> e(8);
+    store.createBatch(8, 0, e.data());
+
+    //  e0 -> e1 -> e2, e3 -> e4, with e5 added under e0 last
+    REQUIRE(transforms.add(e[0]));
+    REQUIRE(transforms.add(e[3]));
+    REQUIRE(transforms.add(e[1], e[0]));
+    REQUIRE(transforms.add(e[2], e[1]));
+    REQUIRE(transforms.add(e[4], e[3]));
+    REQUIRE(transforms.add(e[5], e[0]));
+    REQUIRE_FALSE(transforms.add(e[5]));
+    REQUIRE_FALSE(transforms.add(e[6], e[7]));
+
+    REQUIRE(transforms.size() == 6);
+    REQUIRE(isTopological(transforms));
+    REQUIRE(transforms.entities()[0] == e[0]);
+    REQUIRE(transforms.subtreeSizes()[0] == 4);
+    REQUIRE(transforms.parent(e[2]) == e[1]);
+    REQUIRE(transforms.parent(e[3]) == 0);
+
+    transforms.setPosition(e[0], ckm::vector3(1, 0, 0));
+    transforms.setPosition(e[1], ckm::vector3(0, 2, 0));
+    transforms.setPosition(e[2], ckm::vector3(0, 0, 3));
+    transforms.setScale(e[3], ckm::vector3(2, 2, 2));
+    transforms.setPosition(e[4], ckm::vector3(1, 1, 1));
+    transforms.update();
+    REQUIRE(transforms.dirtyCount() == 0);
+
+    const ckm::matrix4* world = transforms.worldMatrix(e[2]);
+    REQUIRE(nearlyEqual(world->comp[12], 1.0f));
+    REQUIRE(nearlyEqual(world->comp[13], 2.0f));
+    REQUIRE(nearlyEqual(world->comp[14], 3.0f));
+    world = transforms.worldMatrix(e[4]);
+    REQUIRE(nearlyEqual(world->comp[12], 2.0f));
+    REQUIRE(nearlyEqual(world->comp[0], 2.0f));
+
+    SECTION("rotations compose with child offsets")
+    {
+        ckm::quat q(0.0f, 0.0f, std::sin(ckm::kPi * 0.25f),
+                    std::cos(ckm::kPi * 0.25f));
+        transforms.setRotation(e[0], q);
+        transforms.update();
+
+        ckm::matrix4 rotation;
+        ckm::quatToMatrix(rotation, q);
+        world = transforms.worldMatrix(e[1]);
+        REQUIRE(nearlyEqual(world->comp[12], 1.0f + 2.0f * rotation.comp[4]));
+        REQUIRE(nearlyEqual(world->comp[13], 2.0f * rotation.comp[5]));
+        REQUIRE(nearlyEqual(world->comp[14], 2.0f * rotation.comp[6]));
+    }
+
+    SECTION("only dirty subtrees are recomputed")
+    {
+        //  changes reach descendants, while siblings keep their matrices
+        transforms.setPosition(e[3], ckm::vector3(5, 0, 0));
+        transforms.setPosition(e[1], ckm::vector3(0, 4, 0));
+        REQUIRE(transforms.dirtyCount() == 2);
+        transforms.update();
+        REQUIRE(nearlyEqual(transforms.worldMatrix(e[2])->comp[13], 4.0f));
+        REQUIRE(nearlyEqual(transforms.worldMatrix(e[4])->comp[12], 7.0f));
+        REQUIRE(nearlyEqual(transforms.worldMatrix(e[5])->comp[12], 1.0f));
+        REQUIRE(nearlyEqual(transforms.worldMatrix(e[5])->comp[13], 0.0f));
+    }
+
+    SECTION("reparenting keeps subtrees contiguous")
+    {
+        REQUIRE_FALSE(transforms.setParent(e[0], e[2]));
+        REQUIRE(transforms.setParent(e[1], e[4]));
+        REQUIRE(isTopological(transforms));
+        REQUIRE(transforms.subtreeSizes()[transforms.slot(e[0])] == 2);
+        REQUIRE(transforms.subtreeSizes()[transforms.slot(e[3])] == 4);
+        transforms.update();
+        world = transforms.worldMatrix(e[2]);
+        REQUIRE(nearlyEqual(world->comp[12], 2.0f));
+        REQUIRE(nearlyEqual(world->comp[13], 6.0f));
+        REQUIRE(nearlyEqual(world->comp[14], 8.0f));
+
+        REQUIRE(transforms.setParent(e[4], 0));
+        REQUIRE(isTopological(transforms));
+        REQUIRE(transforms.parent(e[4]) == 0);
+        REQUIRE(transforms.subtreeSizes()[transforms.slot(e[3])] == 1);
+    }
+
+    SECTION("removal takes descendants along")
+    {
+        REQUIRE(transforms.remove(e[1]) == 2);
+        REQUIRE_FALSE(transforms.has(e[2]));
+        REQUIRE(transforms.size() == 4);
+        REQUIRE(isTopological(transforms));
+        REQUIRE(transforms.subtreeSizes()[transforms.slot(e[0])] == 2);
+        REQUIRE(transforms.parent(e[4]) == e[3]);
+        REQUIRE(transforms.remove(e[2]) == 0);
+    }
+}
+
+TEST_CASE("transform hierarchies update roots in parallel", "[entity]")
+{
+    JobSystem::InitParams jobParams;
+    jobParams.workerCount = 4;
+    jobParams.jobLimit = 1024;
+    JobSystem jobs(jobParams);
+
+    EntityStore::InitParams params;
+    params.numEntities = 8192;
+    EntityStore store(params);
+
+    TransformHierarchy::InitParams hierarchyParams;
+    hierarchyParams.entityLimit = 8192;
+    hierarchyParams.transformLimit = 4096;
+    TransformHierarchy serial(hierarchyParams);
+    TransformHierarchy parallel(hierarchyParams);
+
+    //  roots with chains of children, built in interleaved order
+    const uint32_t kRoots = 512;
+    const uint32_t kDepth = 4;
+    vector<Entity> e(kRoots * kDepth);
+    store.createBatch((uint32_t)e.size(), 0, e.data());
+    for (uint32_t d = 0; d < kDepth; ++d)
+    {
+        for (uint32_t r = 0; r < kRoots; ++r)
+        {
+            Entity eid = e[r * kDepth + d];
+            Entity parent = d ? e[r * kDepth + d - 1] : 0;
+            ckm::vector3 offset((float)r, (float)d, 1.0f);
+            for (TransformHierarchy* t : { &serial, &parallel })
+            {
+                t->add(eid, parent);
+                t->setPosition(eid, offset);
+            }
+        }
+    }
+    REQUIRE(isTopological(parallel));
+
+    serial.update();
+    parallel.update(jobs, 16);
+    REQUIRE(parallel.dirtyCount() == 0);
+    for (Entity eid : e)
+    {
+        REQUIRE(memcmp(serial.worldMatrix(eid), parallel.worldMatrix(eid),
+                       sizeof(ckm::matrix4)) == 0);
+    }
+
+    const ckm::matrix4* leaf = parallel.worldMatrix(e[10 * kDepth + kDepth - 1]);
+    REQUIRE(nearlyEqual(leaf->comp[12], 40.0f));
+    REQUIRE(nearlyEqual(leaf->comp[13], 6.0f));
+    REQUIRE(nearlyEqual(leaf->comp[14], 4.0f));
+}
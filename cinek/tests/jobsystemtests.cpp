@@ -0,0 +1,506 @@
+#include "catch.hpp"
+
+#include "cinek/jobsystem.hpp"
+#include "cinek/taskscheduler.hpp"
+#include "cinek/parallel.hpp"
+#include "cinek/framepipeline.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace cinek;
+
+static void incrementJob(void* data)
+{
+    reinterpret_cast<std::atomic<int>*>(data)->fetch_add(1);
+}
+
+TEST_CASE("job system executes and waits on batches", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 4;
+    params.jobLimit = 256;
+
+    JobSystem jobs(params);
+
+    REQUIRE(jobs.workerCount() == 4);
+    REQUIRE(jobs.currentWorkerIndex() == 0);
+
+    SECTION("a batch of declared jobs")
+    {
+        std::atomic<int> total(0);
+        JobDecl decls[64];
+        for (auto& decl : decls)
+        {
+            decl.fn = &incrementJob;
+            decl.data = &total;
+        }
+
+        JobCounter counter;
+        jobs.run(decls, 64, &counter);
+        jobs.wait(counter);
+
+        REQUIRE(counter.done());
+        REQUIRE(total == 64);
+    }
+
+    SECTION("more jobs than pooled job records")
+    {
+        std::atomic<int> total(0);
+        JobCounter counter;
+        for (int i = 0; i < 2000; ++i)
+        {
+            std::atomic<int>* t = &total;
+            jobs.run([t]() { t->fetch_add(1); }, &counter);
+        }
+        jobs.wait(counter);
+
+        REQUIRE(total == 2000);
+    }
+
+    SECTION("jobs spawning jobs")
+    {
+        struct Context
+        {
+            JobSystem* jobs;
+            JobCounter* counter;
+            std::atomic<int>* total;
+        };
+        std::atomic<int> total(0);
+        JobCounter counter;
+        Context ctx = { &jobs, &counter, &total };
+        Context* pctx = &ctx;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            jobs.run([pctx]() {
+                for (int j = 0; j < 16; ++j)
+                {
+                    std::atomic<int>* t = pctx->total;
+                    pctx->jobs->run([t]() { t->fetch_add(1); }, pctx->counter);
+                }
+            }, &counter);
+        }
+        jobs.wait(counter);
+
+        REQUIRE(total == 256);
+    }
+}
+
+class SumJobTask : public JobTask
+{
+public:
+    SumJobTask(JobSystem& jobs, int* results, int count) :
+        JobTask(jobs),
+        _results(results),
+        _count(count)
+    {
+    }
+
+protected:
+    void onDispatch(JobSystem& jobs, JobCounter& counter) override
+    {
+        for (int i = 0; i < _count; ++i)
+        {
+            int* result = &_results[i];
+            int value = i;
+            jobs.run([result, value]() { *result = value * 2; }, &counter);
+        }
+    }
+
+private:
+    int* _results;
+    int _count;
+};
+
+TEST_CASE("job tasks poll for completion from a task scheduler", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 2;
+    params.jobLimit = 64;
+
+    JobSystem jobs(params);
+    TaskScheduler scheduler(16);
+
+    int results[32] = { 0 };
+    auto id = scheduler.schedule(allocate_unique<SumJobTask>(jobs, results, 32));
+
+    while (scheduler.isActive(id))
+    {
+        scheduler.update(16);
+        jobs.pump();
+    }
+
+    for (int i = 0; i < 32; ++i)
+    {
+        REQUIRE(results[i] == i * 2);
+    }
+}
+
+class ParallelCountTask : public Task
+{
+public:
+    ParallelCountTask(std::thread::id mainThread, int frames, int* total,
+                      int* mainThreadViolations) :
+        _mainThread(mainThread),
+        _frames(frames),
+        _count(0),
+        _total(total),
+        _mainThreadViolations(mainThreadViolations)
+    {
+        setParallelSafe(true);
+    }
+
+protected:
+    void onBegin() override
+    {
+        checkMainThread();
+    }
+    void onUpdate(uint32_t) override
+    {
+        //  touches only the task's own data
+        if (++_count == _frames)
+            end();
+    }
+    void onEnd() override
+    {
+        checkMainThread();
+        *_total += _count;
+    }
+
+private:
+    void checkMainThread()
+    {
+        if (std::this_thread::get_id() != _mainThread)
+            ++(*_mainThreadViolations);
+    }
+
+    std::thread::id _mainThread;
+    int _frames;
+    int _count;
+    int* _total;
+    int* _mainThreadViolations;
+};
+
+class SerialCountTask : public Task
+{
+public:
+    SerialCountTask(int* updateCount) : _updateCount(updateCount) {}
+
+protected:
+    void onUpdate(uint32_t) override { ++(*_updateCount); }
+
+private:
+    int* _updateCount;
+};
+
+TEST_CASE("parallel-safe tasks update on job system workers", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 4;
+    params.jobLimit = 256;
+
+    JobSystem jobs(params);
+    TaskScheduler scheduler(1024);
+    scheduler.setJobSystem(&jobs);
+
+    const auto mainThread = std::this_thread::get_id();
+    int total = 0;
+    int violations = 0;
+    int serialUpdates = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        auto task = allocate_unique<ParallelCountTask>(mainThread, 1 + (i % 8),
+                                                       &total, &violations);
+        //  chained tasks run on the main thread's update as well
+        task->setNextTask(allocate_unique<ParallelCountTask>(mainThread, 2,
+                                                             &total, &violations));
+        scheduler.schedule(std::move(task));
+    }
+    scheduler.schedule(allocate_unique<SerialCountTask>(&serialUpdates));
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        scheduler.update(16);
+    }
+
+    int expected = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        expected += 1 + (i % 8) + 2;
+    }
+    REQUIRE(total == expected);
+    REQUIRE(violations == 0);
+    REQUIRE(serialUpdates == 10);
+}
+
+struct FiberSum
+{
+    JobSystem* jobs;
+    int depth;
+    std::atomic<int>* leaves;
+};
+
+static void fiberSumJob(void* data)
+{
+    FiberSum* sum = reinterpret_cast<FiberSum*>(data);
+    if (!sum->depth)
+    {
+        sum->leaves->fetch_add(1);
+        return;
+    }
+
+    //  each level waits on its children mid-job, suspending the fiber
+    FiberSum children[2] = {
+        { sum->jobs, sum->depth - 1, sum->leaves },
+        { sum->jobs, sum->depth - 1, sum->leaves }
+    };
+    JobDecl decls[2] = {
+        { &fiberSumJob, &children[0] },
+        { &fiberSumJob, &children[1] }
+    };
+    JobCounter counter;
+    sum->jobs->runFiber(decls, 2, &counter);
+    sum->jobs->wait(counter);
+}
+
+TEST_CASE("fiber jobs suspend while waiting on counters", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 3;
+    params.jobLimit = 256;
+
+    SECTION("deep dependency chains")
+    {
+        params.fiberLimit = 256;
+        JobSystem jobs(params);
+
+        std::atomic<int> leaves(0);
+        FiberSum root = { &jobs, 7, &leaves };
+        JobDecl decl = { &fiberSumJob, &root };
+        JobCounter counter;
+        jobs.runFiber(&decl, 1, &counter);
+        jobs.wait(counter);
+        REQUIRE(leaves == 128);
+    }
+
+    SECTION("jobs beyond the fiber pool run as regular jobs")
+    {
+        params.fiberLimit = 4;
+        JobSystem jobs(params);
+
+        std::atomic<int> leaves(0);
+        FiberSum root = { &jobs, 6, &leaves };
+        JobDecl decl = { &fiberSumJob, &root };
+        JobCounter counter;
+        jobs.runFiber(&decl, 1, &counter);
+        jobs.wait(counter);
+        REQUIRE(leaves == 64);
+    }
+
+    SECTION("fibers resume on any worker")
+    {
+        params.fiberLimit = 64;
+        JobSystem jobs(params);
+
+        std::atomic<int> resumed(0);
+        JobCounter counter;
+        for (int i = 0; i < 32; ++i)
+        {
+            JobSystem* pjobs = &jobs;
+            std::atomic<int>* presumed = &resumed;
+            jobs.runFiber([pjobs, presumed]() {
+                JobCounter inner;
+                pjobs->run([]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }, &inner);
+                pjobs->wait(inner);
+                if (pjobs->currentWorkerIndex() >= 0)
+                    presumed->fetch_add(1);
+            }, &counter);
+        }
+        jobs.wait(counter);
+        REQUIRE(resumed == 32);
+    }
+}
+
+TEST_CASE("parallel loops split ranges across workers", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 4;
+    params.jobLimit = 256;
+
+    JobSystem jobs(params);
+
+    SECTION("every index is visited exactly once")
+    {
+        std::vector<int> hits(100000, 0);
+        std::atomic<int> calls(0);
+        parallelFor(jobs, 0, (uint32_t)hits.size(), 0,
+            [&hits, &calls](uint32_t first, uint32_t last) {
+                calls.fetch_add(1);
+                for (uint32_t i = first; i < last; ++i)
+                    ++hits[i];
+            });
+
+        REQUIRE(calls > 1);
+        REQUIRE(std::count(hits.begin(), hits.end(), 1) == (int)hits.size());
+    }
+
+    SECTION("tiny ranges run serially on the caller")
+    {
+        int calls = 0;
+        int32_t worker = -1;
+        parallelFor(jobs, 10, 20, 0,
+            [&](uint32_t first, uint32_t last) {
+                ++calls;
+                worker = jobs.currentWorkerIndex();
+                REQUIRE(first == 10);
+                REQUIRE(last == 20);
+            });
+
+        REQUIRE(calls == 1);
+        REQUIRE(worker == 0);
+
+        parallelFor(jobs, 5, 5, 0, [&](uint32_t, uint32_t) { ++calls; });
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("reductions combine partials in range order")
+    {
+        std::vector<uint32_t> values(50000);
+        for (uint32_t i = 0; i < values.size(); ++i)
+            values[i] = i;
+
+        auto sum = [&values](uint32_t first, uint32_t last) {
+            uint64_t total = 0;
+            for (uint32_t i = first; i < last; ++i)
+                total += values[i];
+            return total;
+        };
+        auto add = [](uint64_t a, uint64_t b) { return a + b; };
+
+        const uint64_t expected = (uint64_t)49999 * 50000 / 2;
+        REQUIRE(parallelReduce(jobs, 0, 50000, 0, (uint64_t)0, sum, add) == expected);
+        //  a tiny grain is widened to the partial result limit
+        REQUIRE(parallelReduce(jobs, 0, 50000, 1, (uint64_t)0, sum, add) == expected);
+        REQUIRE(parallelReduce(jobs, 0, 0, 0, (uint64_t)7, sum, add) == 7);
+
+        //  order-dependent combine: concatenating chunk starts must
+        //  produce an ascending sequence
+        auto firstIndex = [](uint32_t first, uint32_t) { return (int64_t)first; };
+        auto ordered = [](int64_t a, int64_t b) { return b > a ? b : (int64_t)-1; };
+        REQUIRE(parallelReduce(jobs, 0, 50000, 100, (int64_t)-2, firstIndex, ordered) >= 0);
+    }
+}
+
+namespace {
+
+    struct PipelineProbe
+    {
+        std::atomic<int> active;
+        std::atomic<int> maxActive;
+        std::atomic<bool> ordered;
+        uint32_t lastFrame[3];
+
+        void enter(uint32_t stage, uint32_t frame)
+        {
+            int count = active.fetch_add(1) + 1;
+            int prev = maxActive.load();
+            while (count > prev && !maxActive.compare_exchange_weak(prev, count))
+                ;
+            if (frame != lastFrame[stage] + 1)
+                ordered = false;
+            lastFrame[stage] = frame;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        void leave() { active.fetch_sub(1); }
+    };
+
+    void runPipeline(JobSystem& jobs, uint32_t inFlightLimit, uint32_t frameCount,
+                     PipelineProbe& probe, bool& dataValid)
+    {
+        FramePipeline::InitParams params;
+        params.inFlightLimit = inFlightLimit;
+        params.stageLimit = 3;
+        FramePipeline pipeline(jobs, params);
+
+        PipelineBuffer<uint32_t> simulated(pipeline);
+        PipelineBuffer<uint32_t> culled(pipeline);
+        vector<uint32_t> built;
+
+        pipeline.addStage("simulate", [&](uint32_t frame, uint32_t slot) {
+            probe.enter(0, frame);
+            simulated.at(slot) = frame * 10;
+            probe.leave();
+        });
+        pipeline.addStage("cull", [&](uint32_t frame, uint32_t slot) {
+            probe.enter(1, frame);
+            culled.at(slot) = simulated.at(slot) + 1;
+            probe.leave();
+        });
+        pipeline.addStage("build", [&](uint32_t frame, uint32_t slot) {
+            probe.enter(2, frame);
+            built.push_back(culled.at(slot));
+            probe.leave();
+        });
+
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            REQUIRE(pipeline.submit() == frame);
+            REQUIRE(pipeline.submittedFrameCount() - pipeline.completedFrameCount() <= inFlightLimit);
+        }
+        pipeline.flush();
+
+        REQUIRE(pipeline.completedFrameCount() == frameCount);
+        for (uint32_t stage = 0; stage < pipeline.stageCount(); ++stage)
+        {
+            FramePipeline::Stats stats = pipeline.stageStats(stage);
+            REQUIRE(stats.frameCount == frameCount);
+            REQUIRE(stats.maxUs >= 2000);
+            REQUIRE(stats.totalUs >= stats.maxUs);
+        }
+        REQUIRE(pipeline.frameStats().frameCount == frameCount);
+        REQUIRE(pipeline.frameStats().maxUs >= 6000);
+
+        dataValid = built.size() == frameCount;
+        for (uint32_t frame = 0; dataValid && frame < frameCount; ++frame)
+            dataValid = built[frame] == frame * 10 + 1;
+    }
+
+}
+
+TEST_CASE("frame pipelines overlap stages of consecutive frames", "[jobsystem]")
+{
+    JobSystem::InitParams params;
+    params.workerCount = 4;
+    params.jobLimit = 256;
+
+    JobSystem jobs(params);
+
+    PipelineProbe probe;
+    probe.active = 0;
+    probe.maxActive = 0;
+    probe.ordered = true;
+    for (auto& frame : probe.lastFrame)
+        frame = (uint32_t)-1;
+    bool dataValid = false;
+
+    SECTION("a single frame in flight runs stages serially")
+    {
+        runPipeline(jobs, 1, 8, probe, dataValid);
+        REQUIRE(probe.maxActive == 1);
+    }
+
+    SECTION("several frames in flight run stages concurrently")
+    {
+        runPipeline(jobs, 3, 24, probe, dataValid);
+        REQUIRE(probe.maxActive > 1);
+        REQUIRE(probe.maxActive <= 3);
+    }
+
+    REQUIRE(probe.ordered);
+    REQUIRE(dataValid);
+}
@@ -0,0 +1,243 @@
+#include "catch.hpp"
+
+#include "ckm/aabbtree.hpp"
+#include "ckm/hashgrid.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace ckm;
+
+namespace {
+
+    using Box = AABB<vector3>;
+    using Pair = std::pair<int32_t, int32_t>;
+
+    Box makeBox(std::mt19937& rng, float extent, float maxSize)
+    {
+        std::uniform_real_distribution<float> pos(-extent, extent);
+        std::uniform_real_distribution<float> size(0.1f, maxSize);
+        vector3 min(pos(rng), pos(rng), pos(rng));
+        vector3 max(min.x + size(rng), min.y + size(rng), min.z + size(rng));
+        return Box(min, max);
+    }
+
+    std::vector<int32_t> sorted(std::vector<int32_t> v)
+    {
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+}
+
+TEST_CASE("aabb trees answer queries like a brute force scan", "[spatial]")
+{
+    std::mt19937 rng(1234);
+    aabbtree<vector3, uint32_t> tree(0.25f);
+
+    std::vector<int32_t> proxies;
+    for (uint32_t i = 0; i < 1000; ++i)
+        proxies.push_back(tree.insert(makeBox(rng, 100.0f, 4.0f), i));
+
+    REQUIRE(tree.proxyCount() == 1000);
+    REQUIRE(tree.data(proxies[42]) == 42);
+    REQUIRE(tree.height() <= 20);
+
+    SECTION("box and sphere queries")
+    {
+        for (int q = 0; q < 50; ++q)
+        {
+            Box box = makeBox(rng, 100.0f, 30.0f);
+            std::vector<int32_t> expected, found;
+            for (int32_t p : proxies)
+                if (tree.fatAABB(p).intersects(box))
+                    expected.push_back(p);
+            tree.query(box, [&found](int32_t p) { found.push_back(p); });
+            REQUIRE(sorted(found) == sorted(expected));
+
+            vector3 center = box.min;
+            expected.clear();
+            found.clear();
+            for (int32_t p : proxies)
+                if (tree.fatAABB(p).intersectsWithSphere(center, 12.0f))
+                    expected.push_back(p);
+            tree.querySphere(center, 12.0f, [&found](int32_t p) { found.push_back(p); });
+            REQUIRE(sorted(found) == sorted(expected));
+        }
+    }
+
+    SECTION("all overlapping pairs")
+    {
+        std::vector<Pair> expected, found;
+        for (size_t a = 0; a < proxies.size(); ++a)
+            for (size_t b = a + 1; b < proxies.size(); ++b)
+                if (tree.fatAABB(proxies[a]).intersects(tree.fatAABB(proxies[b])))
+                    expected.emplace_back(std::min(proxies[a], proxies[b]),
+                                          std::max(proxies[a], proxies[b]));
+        tree.findPairs([&found](int32_t a, int32_t b) { found.emplace_back(a, b); });
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        REQUIRE(!found.empty());
+        REQUIRE(found == expected);
+    }
+
+    SECTION("updates reinsert only proxies leaving their fat boxes")
+    {
+        tree.updatePairs([](int32_t, int32_t) {});
+
+        //  nudging within the margin leaves the tree alone
+        Box box = tree.fatAABB(proxies[0]);
+        Box nudged(vector3(box.min.x + 0.3f, box.min.y + 0.3f, box.min.z + 0.3f),
+                   vector3(box.max.x - 0.3f, box.max.y - 0.3f, box.max.z - 0.3f));
+        REQUIRE_FALSE(tree.update(proxies[0], nudged));
+
+        std::vector<bool> moved(proxies.size(), false);
+        for (size_t i = 0; i < proxies.size(); i += 7)
+        {
+            REQUIRE(tree.update(proxies[i], makeBox(rng, 100.0f, 4.0f)));
+            moved[i] = true;
+        }
+        tree.remove(proxies[7]);
+        moved[7] = false;
+        REQUIRE(tree.proxyCount() == 999);
+        REQUIRE(tree.height() <= 20);
+
+        //  pairs are reported once, and only if one side moved
+        std::vector<Pair> expected, found;
+        for (size_t a = 0; a < proxies.size(); ++a)
+        {
+            for (size_t b = a + 1; b < proxies.size(); ++b)
+            {
+                if (a == 7 || b == 7 || !(moved[a] || moved[b]))
+                    continue;
+                if (tree.fatAABB(proxies[a]).intersects(tree.fatAABB(proxies[b])))
+                    expected.emplace_back(std::min(proxies[a], proxies[b]),
+                                          std::max(proxies[a], proxies[b]));
+            }
+        }
+        tree.updatePairs([&found](int32_t a, int32_t b) { found.emplace_back(a, b); });
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        REQUIRE(found == expected);
+
+        found.clear();
+        tree.updatePairs([&found](int32_t a, int32_t b) { found.emplace_back(a, b); });
+        REQUIRE(found.empty());
+    }
+}
+
+TEST_CASE("aabb trees stay balanced under sorted insertion", "[spatial]")
+{
+    aabbtree<vector3> tree(0.0f);
+    std::vector<int32_t> proxies;
+    for (int i = 0; i < 4096; ++i)
+    {
+        float x = (float)i;
+        proxies.push_back(tree.insert(Box(vector3(x, 0, 0), vector3(x + 0.5f, 1, 1)),
+                                      nullptr));
+    }
+    REQUIRE(tree.height() <= 24);
+
+    //  removing half keeps the pool and the tree consistent
+    for (size_t i = 0; i < proxies.size(); i += 2)
+        tree.remove(proxies[i]);
+    REQUIRE(tree.proxyCount() == 2048);
+
+    std::vector<int32_t> found;
+    tree.query(Box(vector3(99.9f, 0, 0), vector3(104.1f, 1, 1)),
+               [&found](int32_t p) { found.push_back(p); });
+    std::vector<int32_t> expected = { proxies[101], proxies[103] };
+    REQUIRE(sorted(found) == sorted(expected));
+
+    tree.clear();
+    REQUIRE(tree.proxyCount() == 0);
+    REQUIRE(tree.height() == 0);
+}
+
+TEST_CASE("hash grids find points within a radius", "[spatial]")
+{
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+
+    //  a small bucket table forces distinct cells to share buckets
+    hashgrid<vector3> grid(2.0f, 64);
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < 5000; ++i)
+        ids.push_back(grid.insert(vector3(pos(rng), pos(rng), pos(rng)), i));
+    grid.rebuild();
+    REQUIRE(grid.size() == 5000);
+    REQUIRE(grid.data(ids[17]) == 17);
+
+    auto bruteForce = [&grid, &ids](const vector3& c, float r) {
+        std::vector<uint32_t> result;
+        for (uint32_t id : ids)
+        {
+            const vector3& p = grid.position(id);
+            float dx = p.x - c.x, dy = p.y - c.y, dz = p.z - c.z;
+            if (dx*dx + dy*dy + dz*dz <= r*r)
+                result.push_back(id);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    auto query = [&grid](const vector3& c, float r) {
+        std::vector<uint32_t> result;
+        grid.queryRadius(c, r, [&result](uint32_t id) { result.push_back(id); });
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    for (int q = 0; q < 50; ++q)
+    {
+        vector3 center(pos(rng), pos(rng), pos(rng));
+        float radius = 1.0f + (float)(q % 8);
+        REQUIRE(query(center, radius) == bruteForce(center, radius));
+    }
+
+    //  moved and removed points show up after the next rebuild
+    for (size_t i = 0; i < ids.size(); i += 3)
+        grid.update(ids[i], vector3(pos(rng), pos(rng), pos(rng)));
+    grid.remove(ids[1]);
+    grid.update(ids[2], vector3(0.5f, 0.5f, 0.5f));
+    grid.rebuild();
+    ids.erase(ids.begin() + 1);
+    REQUIRE(grid.size() == 4999);
+
+    std::vector<uint32_t> near = query(vector3(0.5f, 0.5f, 0.5f), 0.01f);
+    REQUIRE(std::find(near.begin(), near.end(), 2u) != near.end());
+    for (int q = 0; q < 50; ++q)
+    {
+        vector3 center(pos(rng), pos(rng), pos(rng));
+        REQUIRE(query(center, 5.0f) == bruteForce(center, 5.0f));
+    }
+
+    //  removing twice frees the id once
+    grid.remove(1);
+    REQUIRE(grid.size() == 4999);
+
+    //  removed ids are reused
+    REQUIRE(grid.insert(vector3(0.0f), 99) == 1);
+    REQUIRE(grid.insert(vector3(0.0f), 100) == 5000);
+
+    //  until the next rebuild, queries may return a removed point at its
+    //  old position, so its id isn't reused before then
+    grid.remove(ids[3]);
+    REQUIRE(grid.size() == 5000);
+    REQUIRE(grid.insert(vector3(0.0f), 101) == 5001);
+    grid.rebuild();
+    REQUIRE(grid.insert(vector3(0.0f), 102) == ids[3]);
+
+    grid.clear();
+    grid.rebuild();
+    REQUIRE(grid.size() == 0);
+    REQUIRE(query(vector3(0.0f), 100.0f).empty());
+
+    //  points exactly at the radius are found, including on a cell
+    //  boundary and by queries with a zero radius
+    uint32_t edge = grid.insert(vector3(2.0f, 0.0f, 0.0f), 0);
+    grid.rebuild();
+    REQUIRE(query(vector3(0.0f), 2.0f) == std::vector<uint32_t>{ edge });
+    REQUIRE(query(vector3(2.0f, 0.0f, 0.0f), 0.0f) == std::vector<uint32_t>{ edge });
+}
@@ -0,0 +1,958 @@
+#include "catch.hpp"
+
+#include "cinek/taskscheduler.hpp"
+#include "cinek/coroutinetask.hpp"
+#include "cinek/tasktracer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace cinek;
+
+class CountdownTask : public Task
+{
+public:
+    CountdownTask(int frames, int* updateCount=nullptr) :
+        _frames(frames),
+        _updateCount(updateCount)
+    {
+    }
+
+protected:
+    void onUpdate(uint32_t) override
+    {
+        if (_updateCount)
+            ++(*_updateCount);
+        if (--_frames <= 0)
+            end();
+    }
+
+private:
+    int _frames;
+    int* _updateCount;
+};
+
+TEST_CASE("task handles are generational", "[taskscheduler]")
+{
+    TaskScheduler scheduler(16);
+
+    SECTION("completed task handles are rejected")
+    {
+        TaskId id = scheduler.schedule(allocate_unique<CountdownTask>(1));
+        REQUIRE(id != 0);
+        REQUIRE(scheduler.isActive(id));
+
+        scheduler.update(16);
+        REQUIRE(!scheduler.isActive(id));
+
+        //  reusing the freed slot must not revive the old handle
+        TaskId id2 = scheduler.schedule(allocate_unique<CountdownTask>(2));
+        REQUIRE(id2 != id);
+        REQUIRE(!scheduler.isActive(id));
+        REQUIRE(scheduler.isActive(id2));
+
+        scheduler.cancel(id);
+        scheduler.update(16);
+        REQUIRE(scheduler.isActive(id2));
+        scheduler.update(16);
+        REQUIRE(!scheduler.isActive(id2));
+    }
+
+    SECTION("canceling by handle")
+    {
+        int updates = 0;
+        TaskId id = scheduler.schedule(allocate_unique<CountdownTask>(100, &updates));
+        scheduler.update(16);
+        REQUIRE(updates == 1);
+        scheduler.cancel(id);
+        scheduler.update(16);
+        REQUIRE(updates == 1);
+        REQUIRE(!scheduler.isActive(id));
+    }
+
+    SECTION("many short lived tasks")
+    {
+        TaskId ids[64];
+        for (int frame = 0; frame < 100; ++frame)
+        {
+            for (auto& id : ids)
+            {
+                id = scheduler.schedule(allocate_unique<CountdownTask>(1));
+                REQUIRE(id != 0);
+            }
+            scheduler.update(16);
+            for (auto id : ids)
+            {
+                REQUIRE(!scheduler.isActive(id));
+            }
+        }
+    }
+}
+
+TEST_CASE("canceling tasks by context and in bulk", "[taskscheduler]")
+{
+    TaskScheduler scheduler(256);
+    int contexts[3];
+    TaskId ids[3][32];
+
+    for (int c = 0; c < 3; ++c)
+    {
+        for (auto& id : ids[c])
+        {
+            id = scheduler.schedule(allocate_unique<CountdownTask>(100),
+                                    &contexts[c]);
+        }
+    }
+    //  tasks ending on their own leave their context's list
+    scheduler.schedule(allocate_unique<CountdownTask>(1), &contexts[1]);
+    scheduler.update(16);
+
+    SECTION("canceling a context leaves other contexts running")
+    {
+        scheduler.cancelAll(&contexts[1]);
+        scheduler.update(16);
+        for (int c = 0; c < 3; ++c)
+        {
+            for (auto id : ids[c])
+            {
+                REQUIRE(scheduler.isActive(id) == (c != 1));
+            }
+        }
+
+        //  the emptied context can be reused
+        auto id = scheduler.schedule(allocate_unique<CountdownTask>(100),
+                                     &contexts[1]);
+        scheduler.cancelAll(&contexts[0]);
+        scheduler.update(16);
+        REQUIRE(scheduler.isActive(id));
+        REQUIRE(!scheduler.isActive(ids[0][0]));
+        REQUIRE(scheduler.isActive(ids[2][0]));
+    }
+
+    SECTION("contexts outnumbering the task limit")
+    {
+        const int kContextCount = 1000;
+        std::vector<int> manyContexts(kContextCount);
+        std::vector<TaskId> manyIds(kContextCount);
+        for (int c = 0; c < kContextCount; ++c)
+        {
+            manyIds[c] = scheduler.schedule(allocate_unique<CountdownTask>(100),
+                                            &manyContexts[c]);
+        }
+        for (int c = 0; c < kContextCount; c += 2)
+        {
+            scheduler.cancelAll(&manyContexts[c]);
+        }
+        scheduler.update(16);
+        for (int c = 0; c < kContextCount; ++c)
+        {
+            REQUIRE(scheduler.isActive(manyIds[c]) == (c % 2 == 1));
+        }
+        scheduler.cancelAll(&contexts[2]);
+        scheduler.update(16);
+        REQUIRE(!scheduler.isActive(ids[2][0]));
+        REQUIRE(scheduler.isActive(ids[0][0]));
+    }
+
+    SECTION("bulk cancellation ignores stale handles")
+    {
+        TaskId staleId = scheduler.schedule(allocate_unique<CountdownTask>(1));
+        scheduler.update(16);
+        REQUIRE(!scheduler.isActive(staleId));
+
+        TaskId cancelIds[] = { ids[0][3], staleId, ids[2][31], ids[2][31] };
+        scheduler.cancelMany(cancelIds, sizeof(cancelIds)/sizeof(cancelIds[0]));
+        scheduler.update(16);
+        REQUIRE(!scheduler.isActive(ids[0][3]));
+        REQUIRE(!scheduler.isActive(ids[2][31]));
+        REQUIRE(scheduler.isActive(ids[0][4]));
+        REQUIRE(scheduler.isActive(ids[1][0]));
+    }
+}
+
+TEST_CASE("tasks scheduled from other threads", "[taskscheduler]")
+{
+    const int kThreadCount = 4;
+    const int kTasksPerThread = 2000;
+
+    TaskScheduler scheduler(kThreadCount * kTasksPerThread);
+    int updateCount = 0;
+    std::atomic<int> threadsDone(0);
+    int context = 0;
+
+    std::thread threads[kThreadCount];
+    for (auto& thread : threads)
+    {
+        thread = std::thread([&]() {
+            for (int i = 0; i < kTasksPerThread; ++i)
+            {
+                scheduler.scheduleFromAnyThread(
+                    allocate_unique<CountdownTask>(1, &updateCount), &context);
+            }
+            threadsDone.fetch_add(1);
+        });
+    }
+
+    while (threadsDone.load() < kThreadCount)
+    {
+        scheduler.update(16);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    scheduler.update(16);
+    scheduler.update(16);
+
+    REQUIRE(updateCount == kThreadCount * kTasksPerThread);
+
+    //  pending submissions are scheduled with their context
+    scheduler.scheduleFromAnyThread(allocate_unique<CountdownTask>(100, &updateCount),
+                                    &context);
+    scheduler.cancelAll(&context);
+    scheduler.update(16);
+    REQUIRE(updateCount == kThreadCount * kTasksPerThread + 1);
+    scheduler.cancelAll(&context);
+    scheduler.update(16);
+    REQUIRE(updateCount == kThreadCount * kTasksPerThread + 1);
+
+    //  tasks never drained are destroyed with the scheduler
+    scheduler.scheduleFromAnyThread(allocate_unique<CountdownTask>(1));
+}
+
+static int s_heapAllocCount = 0;
+
+static void* countingAlloc(void*, size_t numBytes)
+{
+    ++s_heapAllocCount;
+    return malloc(numBytes);
+}
+
+static void* countingAllocAligned(void*, size_t numBytes, size_t align)
+{
+    ++s_heapAllocCount;
+    void* p = nullptr;
+    return posix_memalign(&p, align, numBytes) == 0 ? p : nullptr;
+}
+
+static void* countingRealloc(void*, void* ptr, size_t numBytes)
+{
+    ++s_heapAllocCount;
+    return realloc(ptr, numBytes);
+}
+
+static void countingFree(void*, void* ptr)
+{
+    free(ptr);
+}
+
+//  routes the general heap through the counting callbacks while in scope,
+//  restoring the defaults even if a REQUIRE fails
+class HeapCountingScope
+{
+public:
+    HeapCountingScope()
+    {
+        cinek_memory_callbacks cbs = {
+            &countingAlloc, &countingAllocAligned, &countingFree,
+            &countingFree, &countingRealloc, nullptr
+        };
+        cinek_alloc_set_callbacks(0, &cbs);
+    }
+    ~HeapCountingScope()
+    {
+        cinek_alloc_set_callbacks(0, nullptr);
+    }
+};
+
+//  spawn runs one frame's worth of work.  After a warm-up frame, the next
+//  32 frames must not allocate from the general heap.
+template<typename Fn>
+static void requireSteadyStateAvoidsHeap(Fn&& spawn)
+{
+    spawn();
+    int baseline = s_heapAllocCount;
+    for (int frame = 0; frame < 32; ++frame)
+    {
+        spawn();
+    }
+    REQUIRE(s_heapAllocCount == baseline);
+}
+
+TEST_CASE("pooled tasks and inline callbacks", "[taskscheduler]")
+{
+    SECTION("callbacks are invoked with the task's end state")
+    {
+        TaskScheduler scheduler(16);
+
+        int ended = 0;
+        int* pended = &ended;
+        auto task = scheduler.createTask<CountdownTask>(2);
+        task->setCallback([pended](Task::State state, Task&, void*) {
+            if (state == Task::State::kEnded)
+                ++(*pended);
+        });
+        scheduler.schedule(std::move(task));
+        scheduler.update(16);
+        scheduler.update(16);
+        REQUIRE(ended == 1);
+    }
+
+    SECTION("pooled tasks may be created on other threads")
+    {
+        const int kThreadCount = 4;
+        const int kTasksPerThread = 1000;
+
+        TaskScheduler scheduler(kThreadCount * kTasksPerThread);
+        int updateCount = 0;
+        std::atomic<int> threadsDone(0);
+
+        //  the update thread frees finished tasks back to the pool while
+        //  producers allocate from it
+        std::thread threads[kThreadCount];
+        for (auto& thread : threads)
+        {
+            thread = std::thread([&]() {
+                for (int i = 0; i < kTasksPerThread; ++i)
+                {
+                    scheduler.scheduleFromAnyThread(
+                        scheduler.createTask<CountdownTask>(1, &updateCount));
+                }
+                threadsDone.fetch_add(1);
+            });
+        }
+
+        while (threadsDone.load() < kThreadCount)
+        {
+            scheduler.update(16);
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        scheduler.update(16);
+        scheduler.update(16);
+
+        REQUIRE(updateCount == kThreadCount * kTasksPerThread);
+    }
+
+    SECTION("steady state spawning avoids the general heap")
+    {
+        HeapCountingScope heapCounting;
+        TaskScheduler scheduler(64);
+
+        int completions = 0;
+        int* pcompletions = &completions;
+        requireSteadyStateAvoidsHeap([&]() {
+            for (int i = 0; i < 32; ++i)
+            {
+                auto task = scheduler.createTask<CountdownTask>(1);
+                task->setCallback([pcompletions](Task::State, Task&, void*) {
+                    ++(*pcompletions);
+                });
+                scheduler.schedule(std::move(task));
+            }
+            scheduler.update(16);
+        });
+        REQUIRE(completions == 33*32);
+    }
+
+    SECTION("steady state spawning with contexts avoids the general heap")
+    {
+        HeapCountingScope heapCounting;
+        TaskScheduler scheduler(64);
+
+        int contexts[4];
+        int updateCount = 0;
+        requireSteadyStateAvoidsHeap([&]() {
+            for (int i = 0; i < 32; ++i)
+            {
+                scheduler.schedule(scheduler.createTask<CountdownTask>(1, &updateCount),
+                                   &contexts[i % 4]);
+            }
+            scheduler.update(16);
+        });
+        REQUIRE(updateCount == 33*32);
+    }
+}
+
+class TimerTask : public Task
+{
+public:
+    TimerTask(const TaskScheduler& scheduler, uint64_t* beginTime,
+              int* updateCount=nullptr, uint32_t sleepMs=0) :
+        _scheduler(scheduler),
+        _beginTime(beginTime),
+        _updateCount(updateCount),
+        _sleepMs(sleepMs)
+    {
+    }
+
+protected:
+    void onBegin() override
+    {
+        *_beginTime = _scheduler.time();
+    }
+    void onUpdate(uint32_t) override
+    {
+        if (_updateCount)
+            ++(*_updateCount);
+        if (_sleepMs)
+        {
+            sleep(_sleepMs);
+            _sleepMs = 0;
+        }
+    }
+
+private:
+    const TaskScheduler& _scheduler;
+    uint64_t* _beginTime;
+    int* _updateCount;
+    uint32_t _sleepMs;
+};
+
+TEST_CASE("delayed, sleeping and periodic tasks", "[taskscheduler]")
+{
+    TaskScheduler scheduler(1024);
+
+    SECTION("delayed tasks begin on the first update after their delay")
+    {
+        const uint32_t kDelays[] = {
+            1, 15, 16, 17, 63, 64, 65, 1000, 4095, 4096, 4097, 250000, 300001
+        };
+        const size_t kCount = sizeof(kDelays)/sizeof(kDelays[0]);
+        uint64_t beginTimes[kCount] = { 0 };
+        TaskId ids[kCount];
+        for (size_t i = 0; i < kCount; ++i)
+        {
+            ids[i] = scheduler.scheduleAfter(
+                allocate_unique<TimerTask>(scheduler, &beginTimes[i]),
+                kDelays[i]);
+        }
+
+        while (scheduler.time() < 310000)
+        {
+            scheduler.update(16);
+        }
+
+        for (size_t i = 0; i < kCount; ++i)
+        {
+            REQUIRE(beginTimes[i] >= kDelays[i]);
+            REQUIRE(beginTimes[i] < kDelays[i] + 16);
+            REQUIRE(scheduler.isActive(ids[i]));
+        }
+    }
+
+    SECTION("sleeping tasks are not updated until they wake")
+    {
+        uint64_t beginTime = 0;
+        int updates = 0;
+        scheduler.schedule(
+            allocate_unique<TimerTask>(scheduler, &beginTime, &updates, 100));
+        scheduler.update(10);
+        REQUIRE(updates == 1);
+        for (int i = 0; i < 9; ++i)
+        {
+            scheduler.update(10);
+        }
+        REQUIRE(updates == 1);
+        scheduler.update(10);
+        REQUIRE(updates == 2);
+    }
+
+    SECTION("periodic tasks update once per period")
+    {
+        uint64_t beginTime = 0;
+        int updates = 0;
+        auto id = scheduler.schedulePeriodic(
+            allocate_unique<TimerTask>(scheduler, &beginTime, &updates), 50);
+        for (int i = 0; i < 100; ++i)
+        {
+            scheduler.update(10);
+        }
+        REQUIRE(updates == 20);
+
+        scheduler.cancel(id);
+        scheduler.update(10);
+        REQUIRE(!scheduler.isActive(id));
+        REQUIRE(updates == 20);
+    }
+}
+
+class BusyTask : public Task
+{
+public:
+    BusyTask(uint32_t busyUs, int tag, std::vector<int>* order) :
+        _busyUs(busyUs),
+        _tag(tag),
+        _order(order)
+    {
+    }
+
+protected:
+    void onUpdate(uint32_t) override
+    {
+        _order->push_back(_tag);
+        auto until = std::chrono::steady_clock::now() +
+                     std::chrono::microseconds(_busyUs);
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+    }
+
+private:
+    uint32_t _busyUs;
+    int _tag;
+    std::vector<int>* _order;
+};
+
+TEST_CASE("task priorities and time budgets", "[taskscheduler]")
+{
+    TaskScheduler scheduler(64);
+    std::vector<int> order;
+
+    auto scheduleBusy = [&](uint32_t busyUs, int tag, Task::Priority priority) {
+        auto task = allocate_unique<BusyTask>(busyUs, tag, &order);
+        task->setPriority(priority);
+        return scheduler.schedule(std::move(task));
+    };
+
+    SECTION("tasks run in priority order")
+    {
+        scheduleBusy(0, 3, Task::Priority::kLow);
+        scheduleBusy(0, 2, Task::Priority::kNormal);
+        scheduleBusy(0, 1, Task::Priority::kHigh);
+        scheduleBusy(0, 0, Task::Priority::kCritical);
+        scheduler.update(16);
+        REQUIRE(order == std::vector<int>({ 0, 1, 2, 3 }));
+        REQUIRE(scheduler.stats().runCount[(size_t)Task::Priority::kLow] == 1);
+        REQUIRE(scheduler.stats().totalDeferredCount == 0);
+    }
+
+    SECTION("exhausted budgets defer tasks fairly")
+    {
+        scheduler.setStarvationLimit(100);
+        scheduleBusy(100, 0, Task::Priority::kCritical);
+        for (int tag = 1; tag <= 4; ++tag)
+            scheduleBusy(25000, tag, Task::Priority::kNormal);
+
+        //  the critical task alone exhausts the budget, but always runs
+        scheduler.update(16, 1);
+        REQUIRE(order == std::vector<int>({ 0 }));
+        REQUIRE(scheduler.stats().deferredCount[(size_t)Task::Priority::kNormal] == 4);
+
+        //  each update runs one normal task, rotating through all of them
+        order.clear();
+        for (int i = 0; i < 4; ++i)
+        {
+            scheduler.update(16, 20000);
+        }
+        REQUIRE(order == std::vector<int>({ 0, 1, 0, 2, 0, 3, 0, 4 }));
+        REQUIRE(scheduler.stats().totalDeferredCount == 4 + 3 + 3 + 3 + 3);
+    }
+
+    SECTION("starving tasks run regardless of budget")
+    {
+        scheduler.setStarvationLimit(2);
+        scheduleBusy(1000, 0, Task::Priority::kCritical);
+        scheduleBusy(0, 1, Task::Priority::kLow);
+
+        scheduler.update(16, 500);
+        scheduler.update(16, 500);
+        REQUIRE(order == std::vector<int>({ 0, 0 }));
+        scheduler.update(16, 500);
+        REQUIRE(order == std::vector<int>({ 0, 0, 0, 1 }));
+        REQUIRE(scheduler.stats().starvedRunCount == 1);
+    }
+}
+
+class RecordTask : public Task
+{
+public:
+    RecordTask(int tag, std::vector<int>* order, int frames=1, bool fails=false) :
+        _tag(tag),
+        _order(order),
+        _frames(frames),
+        _framesLeft(0),
+        _fails(fails)
+    {
+    }
+
+protected:
+    void onBegin() override
+    {
+        _framesLeft = _frames;
+    }
+    void onUpdate(uint32_t) override
+    {
+        if (--_framesLeft > 0)
+            return;
+        _order->push_back(_tag);
+        if (_fails)
+            fail();
+        else
+            end();
+    }
+
+private:
+    int _tag;
+    std::vector<int>* _order;
+    int _frames;
+    int _framesLeft;
+    bool _fails;
+};
+
+TEST_CASE("task graphs", "[taskscheduler]")
+{
+    TaskScheduler scheduler(64);
+    TaskGraph graph;
+    std::vector<int> order;
+
+    SECTION("diamond dependencies are reusable")
+    {
+        auto a = graph.add(allocate_unique<RecordTask>(0, &order));
+        auto b = graph.add(allocate_unique<RecordTask>(1, &order, 3));
+        auto c = graph.add(allocate_unique<RecordTask>(2, &order));
+        auto d = graph.add(allocate_unique<RecordTask>(3, &order));
+        graph.precede(a, b);
+        graph.precede(a, c);
+        graph.precede(b, d);
+        graph.precede(c, d);
+
+        cinek_memory_callbacks cbs = {
+            &countingAlloc, &countingAllocAligned, &countingFree,
+            &countingFree, &countingRealloc, nullptr
+        };
+        order.reserve(64);
+        int baseline = 0;
+        for (int run = 0; run < 4; ++run)
+        {
+            //  the first run builds the graph
+            if (run == 1)
+            {
+                cinek_alloc_set_callbacks(0, &cbs);
+                baseline = s_heapAllocCount;
+            }
+            order.clear();
+            REQUIRE(scheduler.schedule(graph));
+            REQUIRE(!scheduler.schedule(graph));
+            int updates = 0;
+            while (graph.isRunning())
+            {
+                scheduler.update(16);
+                ++updates;
+            }
+            REQUIRE(graph.succeeded());
+            REQUIRE(order == std::vector<int>({ 0, 2, 1, 3 }));
+            REQUIRE(updates == 3);
+        }
+        REQUIRE(s_heapAllocCount == baseline);
+        cinek_alloc_set_callbacks(0, nullptr);
+    }
+
+    SECTION("failed tasks skip their successors")
+    {
+        auto a = graph.add(allocate_unique<RecordTask>(0, &order));
+        auto b = graph.add(allocate_unique<RecordTask>(1, &order, 1, true));
+        auto c = graph.add(allocate_unique<RecordTask>(2, &order));
+        auto d = graph.add(allocate_unique<RecordTask>(3, &order));
+        auto e = graph.add(allocate_unique<RecordTask>(4, &order));
+        graph.precede(a, b);
+        graph.precede(a, c);
+        graph.precede(b, d);
+        graph.precede(d, e);
+
+        REQUIRE(scheduler.schedule(graph));
+        while (graph.isRunning())
+        {
+            scheduler.update(16);
+        }
+        REQUIRE(!graph.succeeded());
+        REQUIRE(order == std::vector<int>({ 0, 1, 2 }));
+    }
+
+    SECTION("graphs with cycles are rejected")
+    {
+        auto a = graph.add(allocate_unique<RecordTask>(0, &order));
+        auto b = graph.add(allocate_unique<RecordTask>(1, &order));
+        auto c = graph.add(allocate_unique<RecordTask>(2, &order));
+        graph.precede(a, b);
+        graph.precede(b, c);
+        graph.precede(c, b);
+        REQUIRE(!scheduler.schedule(graph));
+        REQUIRE(!graph.isRunning());
+    }
+}
+
+class TracedTask : public CountdownTask
+{
+public:
+    static const TaskClassId kClassId;
+
+    TracedTask(int frames) : CountdownTask(frames) {}
+
+    const TaskClassId& classId() const override { return kClassId; }
+};
+
+const TaskClassId TracedTask::kClassId = {
+    { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+      0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 }
+};
+
+static size_t countOccurrences(const std::string& str, const char* pattern)
+{
+    size_t count = 0;
+    for (size_t pos = str.find(pattern); pos != std::string::npos;
+         pos = str.find(pattern, pos + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE("task tracing", "[taskscheduler]")
+{
+    TaskTracer::InitParams params;
+    params.frameLimit = 4;
+    params.eventsPerFrame = 16;
+    TaskTracer tracer(params);
+    tracer.setClassName(TracedTask::kClassId, "TracedTask");
+
+    TaskScheduler scheduler(16);
+    scheduler.setTracer(&tracer);
+
+    scheduler.schedule(allocate_unique<TracedTask>(3));
+    scheduler.schedule(allocate_unique<TracedTask>(6));
+    scheduler.schedule(allocate_unique<CountdownTask>(6));
+    for (int i = 0; i < 6; ++i)
+    {
+        scheduler.update(16);
+    }
+
+    SECTION("statistics are aggregated by task class")
+    {
+        auto& stats = tracer.classStats();
+        REQUIRE(stats.size() == 2);
+        auto it = stats.find(TracedTask::kClassId);
+        REQUIRE(it != stats.end());
+        REQUIRE(it->second.callCount[TaskTracer::kBegin] == 2);
+        REQUIRE(it->second.callCount[TaskTracer::kUpdate] == 9);
+        REQUIRE(it->second.callCount[TaskTracer::kEnd] == 2);
+        REQUIRE(it->second.maxNs[TaskTracer::kUpdate] <=
+                it->second.totalNs[TaskTracer::kUpdate]);
+        REQUIRE(tracer.droppedEventCount() == 0);
+    }
+
+    SECTION("recent updates are exported as a chrome trace")
+    {
+        std::ostringstream out;
+        tracer.exportChromeTrace(out);
+        std::string trace = out.str();
+        REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+        //  only the four most recent updates are retained
+        REQUIRE(countOccurrences(trace, "\"name\":\"update\"") == 4);
+        //  updates 3-6 hold the shorter traced task's final update and end,
+        //  and four updates and an end from the longer traced task
+        REQUIRE(countOccurrences(trace, "\"name\":\"TracedTask\"") == 7);
+        REQUIRE(countOccurrences(trace, "\"cat\":\"onEnd\"") == 3);
+    }
+
+    SECTION("updates are attributed to the updating thread")
+    {
+        std::string trace;
+        std::thread exporter([&tracer, &trace]() {
+            std::ostringstream out;
+            tracer.exportChromeTrace(out);
+            trace = out.str();
+        });
+        exporter.join();
+
+        //  every event, including the updates, ran on the test's thread
+        size_t pos = trace.find("\"tid\":");
+        REQUIRE(pos != std::string::npos);
+        std::string tid = trace.substr(pos, trace.find(',', pos) + 1 - pos);
+        REQUIRE(countOccurrences(trace, tid.c_str()) ==
+                countOccurrences(trace, "\"tid\":"));
+    }
+
+    SECTION("class names are escaped")
+    {
+        tracer.setClassName(TracedTask::kClassId, "Traced \"quoted\\task\"");
+        std::ostringstream out;
+        tracer.exportChromeTrace(out);
+        REQUIRE(countOccurrences(out.str(),
+            "\"name\":\"Traced \\\"quoted\\\\task\\\"\"") == 7);
+    }
+
+    SECTION("disabled tracing records nothing")
+    {
+        scheduler.setTracer(nullptr);
+        tracer.resetStats();
+        scheduler.schedule(allocate_unique<TracedTask>(1));
+        scheduler.update(16);
+        REQUIRE(tracer.classStats().empty());
+    }
+}
+
+#if defined(__cpp_impl_coroutine)
+
+static TaskRoutine countFrames(TaskScheduler&, int frames, int* count)
+{
+    for (int i = 0; i < frames; ++i)
+    {
+        ++(*count);
+        co_await nextFrame();
+    }
+}
+
+static TaskRoutine sequence
+(
+    TaskScheduler& scheduler,
+    std::vector<uint64_t>* times,
+    int* count
+)
+{
+    times->push_back(scheduler.time());
+    co_await delay(100);
+    times->push_back(scheduler.time());
+    co_await nextFrame();
+    times->push_back(scheduler.time());
+    TaskId counterId = scheduler.schedule(
+        scheduler.createTask<CoroutineTask>(countFrames(scheduler, 5, count)));
+    co_await counterId;
+    times->push_back(scheduler.time());
+}
+
+static TaskRoutine readFile
+(
+    TaskScheduler&,
+    ckio_handle* handle,
+    uint8_t* buffer,
+    size_t size,
+    ckio_status* status,
+    size_t* bytesRead
+)
+{
+    ckio_read(handle, buffer, size);
+    *status = co_await handle;
+    ckio_get_status(handle, bytesRead);
+}
+
+TEST_CASE("coroutine tasks", "[taskscheduler]")
+{
+    SECTION("routines await frames, delays and tasks")
+    {
+        TaskScheduler scheduler(16);
+        std::vector<uint64_t> times;
+        int count = 0;
+
+        int ended = 0;
+        int* pended = &ended;
+        auto id = scheduler.schedule(scheduler.createTask<CoroutineTask>(
+            sequence(scheduler, &times, &count),
+            [pended](Task::State state, Task&, void*) {
+                if (state == Task::State::kEnded)
+                    ++(*pended);
+            }));
+
+        while (scheduler.isActive(id) && scheduler.time() < 1000)
+        {
+            scheduler.update(10);
+        }
+        REQUIRE(ended == 1);
+        REQUIRE(count == 5);
+        REQUIRE(times.size() == 4);
+        REQUIRE(times[0] == 10);
+        REQUIRE(times[1] == 110);
+        REQUIRE(times[2] == 120);
+        //  the counter first runs in the update it's scheduled, ending on
+        //  its sixth update
+        REQUIRE(times[3] == 180);
+    }
+
+    SECTION("canceling a suspended routine")
+    {
+        TaskScheduler scheduler(16);
+        int count = 0;
+        auto id = scheduler.schedule(scheduler.createTask<CoroutineTask>(
+            countFrames(scheduler, 100, &count)));
+        scheduler.update(10);
+        scheduler.update(10);
+        scheduler.cancel(id);
+        scheduler.update(10);
+        REQUIRE(count == 2);
+        REQUIRE(!scheduler.isActive(id));
+    }
+
+    SECTION("routines await ckio requests")
+    {
+        const char* kPath = "ckcoretests_ioawaiter.bin";
+        const char kContents[] = "awaiting a ckio request";
+        FILE* fp = fopen(kPath, "wb");
+        REQUIRE(fp);
+        fwrite(kContents, 1, sizeof(kContents), fp);
+        fclose(fp);
+
+        TaskScheduler scheduler(16);
+        uint8_t buffer[64] = { 0 };
+        ckio_status status = kCKIO_Pending;
+        size_t bytesRead = 0;
+
+        //  an asynchronous read resumes the routine once it completes
+        ckio_handle* handle = ckio_open(kPath, kCKIO_ReadFlag | kCKIO_Async);
+        REQUIRE(handle);
+        auto id = scheduler.schedule(scheduler.createTask<CoroutineTask>(
+            readFile(scheduler, handle, buffer, sizeof(buffer), &status, &bytesRead)));
+        while (scheduler.isActive(id) && scheduler.time() < 10000)
+        {
+            scheduler.update(10);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ckio_close(handle);
+        REQUIRE(!scheduler.isActive(id));
+        REQUIRE(status == kCKIO_Success);
+        REQUIRE(bytesRead == sizeof(kContents));
+        REQUIRE(memcmp(buffer, kContents, sizeof(kContents)) == 0);
+
+        //  a completed synchronous read at the end of the file resumes
+        //  the routine immediately with its status
+        handle = ckio_open(kPath, kCKIO_ReadFlag);
+        REQUIRE(handle);
+        ckio_read(handle, buffer, sizeof(buffer));
+        status = kCKIO_Pending;
+        id = scheduler.schedule(scheduler.createTask<CoroutineTask>(
+            readFile(scheduler, handle, buffer, sizeof(buffer), &status, &bytesRead)));
+        scheduler.update(10);
+        ckio_close(handle);
+        REQUIRE(!scheduler.isActive(id));
+        REQUIRE(status == kCKIO_EOF);
+
+        remove(kPath);
+    }
+
+    SECTION("routine frames avoid the general heap")
+    {
+        HeapCountingScope heapCounting;
+        TaskScheduler scheduler(64);
+
+        int count = 0;
+        requireSteadyStateAvoidsHeap([&]() {
+            for (int i = 0; i < 32; ++i)
+            {
+                scheduler.schedule(scheduler.createTask<CoroutineTask>(
+                    countFrames(scheduler, 1, &count)));
+            }
+            scheduler.update(16);
+            scheduler.update(16);
+        });
+        REQUIRE(count == 33*32);
+    }
+}
+
+#endif
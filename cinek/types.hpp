@@ -34,6 +34,7 @@
 #include "ckdefs.h"
 
 #include <type_traits>
+#include <utility>
 
 namespace cinek {
     template<typename _T, size_t _Align> class ObjectPool;
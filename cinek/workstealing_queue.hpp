@@ -0,0 +1,166 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    cinek/workstealing_queue.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   A fixed capacity Chase-Lev work stealing deque
+ * @copyright Cinekine
+ */
+
+/*
+ * Based on "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * (Lê, Pop, Cohen, Zappa Nardelli - PPoPP 2013), which gives a C11 memory
+ * model mapping of the Chase-Lev dynamic circular work-stealing deque.
+ *
+ * This version uses a fixed capacity buffer.  The owning thread pushes and
+ * pops from the bottom, while any other thread may steal from the top.
+ */
+
+#ifndef CINEK_WORKSTEALING_QUEUE_HPP
+#define CINEK_WORKSTEALING_QUEUE_HPP
+
+#include "cinek/types.hpp"
+
+#include <atomic>
+
+namespace cinek {
+
+template<typename Element, size_t Size>
+class WorkStealingQueue
+{
+    CK_CLASS_NON_COPYABLE(WorkStealingQueue);
+
+    static_assert((Size & (Size-1)) == 0, "Size must be a power of two");
+
+public:
+    enum
+    {
+        kCapacity = Size
+    };
+
+    WorkStealingQueue();
+
+    /** Owner only.  Returns false if the queue is full */
+    bool push(Element item);
+    /** Owner only.  Returns false if the queue is empty */
+    bool pop(Element& item);
+    /** Any thread.  Returns false if the queue is empty or the steal lost a
+     *  race against another thief or the owner */
+    bool steal(Element& item);
+
+    /** A snapshot of the item count, which may be stale by the time it's
+     *  returned */
+    size_t sizeHint() const;
+
+private:
+    std::atomic<int64_t> _top;
+    std::atomic<int64_t> _bottom;
+    std::atomic<Element> _array[kCapacity];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename Element, size_t Size>
+WorkStealingQueue<Element, Size>::WorkStealingQueue() :
+    _top(0),
+    _bottom(0)
+{
+    for (auto& e : _array)
+        e.store(Element(), std::memory_order_relaxed);
+}
+
+template<typename Element, size_t Size>
+bool WorkStealingQueue<Element, Size>::push(Element item)
+{
+    const int64_t b = _bottom.load(std::memory_order_relaxed);
+    const int64_t t = _top.load(std::memory_order_acquire);
+    if (b - t >= (int64_t)kCapacity)
+        return false;   // full queue
+
+    _array[b & (kCapacity-1)].store(item, std::memory_order_relaxed);
+    //  a release store instead of the paper's release fence + relaxed store,
+    //  which is equivalent here and understood by race detectors.
+    _bottom.store(b+1, std::memory_order_release);
+    return true;
+}
+
+template<typename Element, size_t Size>
+bool WorkStealingQueue<Element, Size>::pop(Element& item)
+{
+    const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = _top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        //  empty queue - restore bottom
+        _bottom.store(b+1, std::memory_order_relaxed);
+        return false;
+    }
+
+    item = _array[b & (kCapacity-1)].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        //  last item - race against thieves for it
+        bool won = _top.compare_exchange_strong(t, t+1,
+                                                std::memory_order_seq_cst,
+                                                std::memory_order_relaxed);
+        _bottom.store(b+1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template<typename Element, size_t Size>
+bool WorkStealingQueue<Element, Size>::steal(Element& item)
+{
+    int64_t t = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = _bottom.load(std::memory_order_acquire);
+    if (t >= b)
+        return false;
+
+    Element e = _array[t & (kCapacity-1)].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(t, t+1,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+    {
+        return false;
+    }
+    item = e;
+    return true;
+}
+
+template<typename Element, size_t Size>
+size_t WorkStealingQueue<Element, Size>::sizeHint() const
+{
+    const int64_t b = _bottom.load(std::memory_order_relaxed);
+    const int64_t t = _top.load(std::memory_order_relaxed);
+    return b > t ? (size_t)(b - t) : 0;
+}
+
+} /* namespace cinek */
+
+#endif
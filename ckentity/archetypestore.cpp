@@ -0,0 +1,440 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/archetypestore.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Archetype chunk storage for entity components
+ * @copyright Cinekine
+ */
+
+#include "archetypestore.hpp"
+
+namespace cinek {
+
+namespace {
+
+    inline uint32_t alignOffset(uint32_t offset, uint32_t align)
+    {
+        return (offset + align - 1) & ~(align - 1);
+    }
+
+    inline uint32_t& chunkCount(uint8_t* data)
+    {
+        return *reinterpret_cast<uint32_t*>(data);
+    }
+
+}
+
+ArchetypeStore::Archetype::Archetype(const Allocator& allocator) :
+    capacity(0),
+    entityCount(0),
+    types(allocator),
+    offsets(allocator),
+    chunks(allocator),
+    edges(allocator)
+{
+    memset(columns, kNoColumn, sizeof(columns));
+}
+
+void* ArchetypeStore::Chunk::column(ComponentTypeId type) const
+{
+    if (type >= kComponentTypeLimit)
+        return nullptr;
+    const Archetype& archetype = *_store->_archetypes[_archetype];
+    uint8_t column = archetype.columns[type];
+    if (column == kNoColumn)
+        return nullptr;
+    return _data + archetype.offsets[column];
+}
+
+ArchetypeStore::ArchetypeStore
+(
+    const InitParams& params,
+    const Allocator& allocator
+) :
+    _allocator(allocator),
+    _types(allocator),
+    _archetypes(allocator),
+    _archetypeIndex(allocator),
+    _queries(allocator),
+    _locations(allocator),
+    _entityCount(0)
+{
+    _archetypes.reserve(params.archetypeLimit);
+    _locations.reserve(params.entityLimit);
+
+    //  archetype zero holds entities without components
+    findArchetype(ComponentSignature());
+}
+
+ArchetypeStore::~ArchetypeStore()
+{
+    for (Archetype* archetype : _archetypes)
+    {
+        for (uint8_t* chunk : archetype->chunks)
+            _allocator.freeAligned(chunk);
+        _allocator.deleteItem(archetype);
+    }
+}
+
+ComponentTypeId ArchetypeStore::registerComponent
+(
+    const void* key,
+    uint32_t size,
+    uint32_t align
+)
+{
+    ComponentTypeId type = findComponentType(key);
+    if (type != kInvalidComponentType)
+        return type;
+
+    if (_types.size() >= kComponentTypeLimit)
+    {
+        CK_LOG_ERROR("ArchetypeStore", "Component type limit (%u) reached",
+                     (uint32_t)kComponentTypeLimit);
+        return kInvalidComponentType;
+    }
+    ComponentInfo info = { key, size, align };
+    _types.push_back(info);
+    return (ComponentTypeId)_types.size() - 1;
+}
+
+ComponentTypeId ArchetypeStore::findComponentType(const void* key) const
+{
+    for (uint32_t i = 0; i < _types.size(); ++i)
+    {
+        if (_types[i].key == key)
+            return i;
+    }
+    return kInvalidComponentType;
+}
+
+uint32_t ArchetypeStore::componentSize(ComponentTypeId type) const
+{
+    CK_ASSERT_RETURN_VALUE(type < _types.size(), 0);
+    return _types[type].size;
+}
+
+const ComponentSignature& ArchetypeStore::archetypeSignature(uint32_t archetype) const
+{
+    return _archetypes[archetype]->signature;
+}
+
+uint32_t ArchetypeStore::archetypeChunkCount(uint32_t archetype) const
+{
+    return (uint32_t)_archetypes[archetype]->chunks.size();
+}
+
+uint32_t ArchetypeStore::archetypeChunkCapacity(uint32_t archetype) const
+{
+    return _archetypes[archetype]->capacity;
+}
+
+auto ArchetypeStore::archetypeChunk(uint32_t archetype, uint32_t chunk) const -> Chunk
+{
+    return Chunk(this, archetype, _archetypes[archetype]->chunks[chunk]);
+}
+
+uint32_t ArchetypeStore::findArchetype(const ComponentSignature& signature)
+{
+    auto it = _archetypeIndex.find(signature);
+    if (it != _archetypeIndex.end())
+        return it->second;
+
+    Archetype* archetype = _allocator.newItem<Archetype>(_allocator);
+    archetype->signature = signature;
+
+    uint32_t rowSize = sizeof(Entity);
+    for (ComponentTypeId type = 0; type < _types.size(); ++type)
+    {
+        if (!signature.test(type))
+            continue;
+        archetype->columns[type] = (uint8_t)archetype->types.size();
+        archetype->types.push_back(type);
+        rowSize += _types[type].size;
+    }
+    archetype->offsets.resize(archetype->types.size());
+
+    //  start from the unpadded row count and shrink until the columns fit
+    //  with their alignment padding
+    uint32_t capacity = (kChunkSize - kChunkHeaderSize) / rowSize;
+    for (; capacity > 0; --capacity)
+    {
+        uint32_t offset = kChunkHeaderSize + capacity * sizeof(Entity);
+        for (uint32_t i = 0; i < archetype->types.size(); ++i)
+        {
+            const ComponentInfo& info = _types[archetype->types[i]];
+            offset = alignOffset(offset, info.align);
+            archetype->offsets[i] = offset;
+            offset += capacity * info.size;
+        }
+        if (offset <= kChunkSize)
+            break;
+    }
+    CK_ASSERT(capacity > 0);
+    archetype->capacity = capacity;
+
+    _archetypes.push_back(archetype);
+    uint32_t index = (uint32_t)_archetypes.size() - 1;
+    _archetypeIndex.emplace(signature, index);
+
+    for (Query& query : _queries)
+    {
+        if (query.query.matches(signature))
+            query.archetypes.push_back(index);
+    }
+    return index;
+}
+
+auto ArchetypeStore::registerQuery(const ComponentQuery& query) -> QueryId
+{
+    for (QueryId id = 0; id < _queries.size(); ++id)
+    {
+        if (_queries[id].query.required == query.required &&
+            _queries[id].query.excluded == query.excluded)
+            return id;
+    }
+
+    Query entry = { query, vector<uint32_t>(_allocator) };
+    for (uint32_t a = 0; a < _archetypes.size(); ++a)
+    {
+        if (query.matches(_archetypes[a]->signature))
+            entry.archetypes.push_back(a);
+    }
+    _queries.push_back(std::move(entry));
+    return (QueryId)_queries.size() - 1;
+}
+
+uint32_t ArchetypeStore::queryEntityCount(QueryId id) const
+{
+    uint32_t count = 0;
+    for (uint32_t a : _queries[id].archetypes)
+        count += _archetypes[a]->entityCount;
+    return count;
+}
+
+uint32_t ArchetypeStore::transition
+(
+    uint32_t archetype,
+    ComponentTypeId type,
+    bool added
+)
+{
+    uint32_t key = (type << 1) | (added ? 1 : 0);
+    auto& edges = _archetypes[archetype]->edges;
+    auto it = edges.find(key);
+    if (it != edges.end())
+        return it->second;
+
+    ComponentSignature signature = _archetypes[archetype]->signature;
+    if (added)
+        signature.set(type);
+    else
+        signature.reset(type);
+    uint32_t target = findArchetype(signature);
+    _archetypes[archetype]->edges.emplace(key, target);
+    return target;
+}
+
+auto ArchetypeStore::locate(Entity eid) const -> const Location*
+{
+    EntityIndexType index = cinek_entity_index(eid);
+    if (!eid || index >= _locations.size() || _locations[index].eid != eid)
+        return nullptr;
+    return &_locations[index];
+}
+
+void ArchetypeStore::allocRow(Location& location, uint32_t index)
+{
+    Archetype& archetype = *_archetypes[index];
+    if (archetype.entityCount == archetype.chunks.size() * archetype.capacity)
+    {
+        uint8_t* data = reinterpret_cast<uint8_t*>(
+            _allocator.allocAligned(kChunkSize, kChunkAlign));
+        CK_ASSERT(data);
+        chunkCount(data) = 0;
+        archetype.chunks.push_back(data);
+    }
+
+    location.archetype = index;
+    location.chunk = archetype.entityCount / archetype.capacity;
+    location.row = archetype.entityCount % archetype.capacity;
+    ++archetype.entityCount;
+
+    uint8_t* data = archetype.chunks[location.chunk];
+    ++chunkCount(data);
+    reinterpret_cast<Entity*>(data + kChunkHeaderSize)[location.row] = location.eid;
+    for (uint32_t i = 0; i < archetype.types.size(); ++i)
+    {
+        uint32_t size = _types[archetype.types[i]].size;
+        memset(data + archetype.offsets[i] + location.row * size, 0, size);
+    }
+}
+
+void ArchetypeStore::freeRow(const Location& location)
+{
+    Archetype& archetype = *_archetypes[location.archetype];
+    uint32_t last = archetype.entityCount - 1;
+    uint32_t lastChunk = last / archetype.capacity;
+    uint32_t lastRow = last % archetype.capacity;
+    uint8_t* lastData = archetype.chunks[lastChunk];
+
+    if (lastChunk != location.chunk || lastRow != location.row)
+    {
+        //  fill the vacated row with the archetype's last entity
+        uint8_t* data = archetype.chunks[location.chunk];
+        Entity moved = reinterpret_cast<Entity*>(lastData + kChunkHeaderSize)[lastRow];
+        reinterpret_cast<Entity*>(data + kChunkHeaderSize)[location.row] = moved;
+        for (uint32_t i = 0; i < archetype.types.size(); ++i)
+        {
+            uint32_t size = _types[archetype.types[i]].size;
+            uint32_t offset = archetype.offsets[i];
+            memcpy(data + offset + location.row * size,
+                   lastData + offset + lastRow * size, size);
+        }
+        Location& movedLocation = _locations[cinek_entity_index(moved)];
+        movedLocation.chunk = location.chunk;
+        movedLocation.row = location.row;
+    }
+
+    --archetype.entityCount;
+    if (!--chunkCount(lastData))
+    {
+        _allocator.freeAligned(lastData);
+        archetype.chunks.pop_back();
+    }
+}
+
+void ArchetypeStore::moveEntity(Location& location, uint32_t index)
+{
+    const Location source = location;
+    allocRow(location, index);
+
+    const Archetype& from = *_archetypes[source.archetype];
+    const Archetype& to = *_archetypes[index];
+    const uint8_t* fromData = from.chunks[source.chunk];
+    uint8_t* toData = to.chunks[location.chunk];
+    for (uint32_t i = 0; i < to.types.size(); ++i)
+    {
+        uint8_t column = from.columns[to.types[i]];
+        if (column == kNoColumn)
+            continue;
+        uint32_t size = _types[to.types[i]].size;
+        memcpy(toData + to.offsets[i] + location.row * size,
+               fromData + from.offsets[column] + source.row * size, size);
+    }
+
+    freeRow(source);
+}
+
+void ArchetypeStore::insert(Entity eid)
+{
+    CK_ASSERT_RETURN(eid);
+
+    EntityIndexType index = cinek_entity_index(eid);
+    if (index >= _locations.size())
+        _locations.resize(index + 1, Location { 0, 0, 0, 0 });
+
+    Location& location = _locations[index];
+    if (location.eid == eid)
+        return;
+    if (location.eid)
+    {
+        //  a destroyed entity that was never erased
+        freeRow(location);
+        --_entityCount;
+    }
+    location.eid = eid;
+    allocRow(location, 0);
+    ++_entityCount;
+}
+
+void ArchetypeStore::erase(Entity eid)
+{
+    if (!locate(eid))
+        return;
+
+    Location& location = _locations[cinek_entity_index(eid)];
+    freeRow(location);
+    location.eid = 0;
+    --_entityCount;
+}
+
+bool ArchetypeStore::contains(Entity eid) const
+{
+    return locate(eid) != nullptr;
+}
+
+void* ArchetypeStore::add(Entity eid, ComponentTypeId type)
+{
+    CK_ASSERT_RETURN_VALUE(type < _types.size(), nullptr);
+
+    if (!locate(eid))
+        insert(eid);
+
+    Location& location = _locations[cinek_entity_index(eid)];
+    if (!_archetypes[location.archetype]->signature.test(type))
+        moveEntity(location, transition(location.archetype, type, true));
+
+    return get(eid, type);
+}
+
+bool ArchetypeStore::remove(Entity eid, ComponentTypeId type)
+{
+    CK_ASSERT_RETURN_VALUE(type < _types.size(), false);
+
+    if (!locate(eid))
+        return false;
+
+    Location& location = _locations[cinek_entity_index(eid)];
+    if (!_archetypes[location.archetype]->signature.test(type))
+        return false;
+
+    moveEntity(location, transition(location.archetype, type, false));
+    return true;
+}
+
+void* ArchetypeStore::get(Entity eid, ComponentTypeId type) const
+{
+    const Location* location = locate(eid);
+    if (!location || type >= _types.size())
+        return nullptr;
+
+    const Archetype& archetype = *_archetypes[location->archetype];
+    uint8_t column = archetype.columns[type];
+    if (column == kNoColumn)
+        return nullptr;
+    return archetype.chunks[location->chunk] + archetype.offsets[column] +
+           location->row * _types[type].size;
+}
+
+ComponentSignature ArchetypeStore::signature(Entity eid) const
+{
+    const Location* location = locate(eid);
+    if (!location)
+        return ComponentSignature();
+    return _archetypes[location->archetype]->signature;
+}
+
+} /* namespace cinek */
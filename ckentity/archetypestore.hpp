@@ -0,0 +1,394 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/archetypestore.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Archetype chunk storage for entity components
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_ARCHETYPE_STORE_HPP
+#define CINEK_ARCHETYPE_STORE_HPP
+
+#include "entity.h"
+#include "componentsignature.hpp"
+
+#include "cinek/vector.hpp"
+#include "cinek/map.hpp"
+#include "cinek/allocator.hpp"
+#include "cinek/debug.h"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace cinek {
+
+/**
+ *  @class  ArchetypeStore
+ *  @brief  Stores entity components grouped by archetype in SoA chunks
+ *
+ *  An archetype is the set of component types owned by an entity.  All
+ *  entities of an archetype live in fixed-size chunks of kChunkSize bytes,
+ *  each holding a column of entity ids followed by a column per component
+ *  type.  Systems reading several components of the same entities walk
+ *  these columns in lockstep, touching only contiguous memory.
+ *
+ *  Adding or removing a component moves the entity into the archetype with
+ *  the new component set, copying its remaining components.  Transitions
+ *  between archetypes are cached, so repeated moves cost no lookup.  Rows
+ *  stay packed - a vacated row is filled by the archetype's last entity.
+ *
+ *  Entity ids are handed out by an EntityStore; this store only holds
+ *  components.  Component types must be trivially copyable, and are
+ *  registered with registerComponent<T>() before use.
+ */
+class ArchetypeStore
+{
+    CK_CLASS_NON_COPYABLE(ArchetypeStore);
+
+public:
+    /** Size of an archetype chunk, in bytes */
+    static constexpr uint32_t kChunkSize = 16 * 1024;
+    /** Alignment of chunks and of the largest supported component */
+    static constexpr uint32_t kChunkAlign = 64;
+    /** Maximum number of registered component types */
+    static constexpr uint32_t kComponentTypeLimit = ComponentSignature::kTypeLimit;
+
+    static const ComponentTypeId kInvalidComponentType = 0xffffffff;
+
+    using QueryId = uint32_t;
+
+    struct InitParams
+    {
+        /** Number of entity indices to reserve */
+        uint32_t entityLimit;
+        /** Number of archetypes to reserve */
+        uint32_t archetypeLimit;
+    };
+
+    /**
+     *  @class  Chunk
+     *  @brief  A view of one chunk's rows, passed to chunk iterators
+     */
+    class Chunk
+    {
+    public:
+        /** @return Number of occupied rows */
+        uint32_t size() const { return *reinterpret_cast<const uint32_t*>(_data); }
+        /** @return Entity ids of each row */
+        const Entity* entities() const {
+            return reinterpret_cast<const Entity*>(_data + kChunkHeaderSize);
+        }
+        /** @return The column of a component type, or nullptr if absent */
+        void* column(ComponentTypeId type) const;
+        /** @return The typed column of T, or nullptr if absent */
+        template<typename T> T* column(ComponentTypeId type) const {
+            return reinterpret_cast<T*>(column(type));
+        }
+
+    private:
+        friend class ArchetypeStore;
+        Chunk(const ArchetypeStore* store, uint32_t archetype, uint8_t* data) :
+            _store(store), _archetype(archetype), _data(data) {}
+
+        const ArchetypeStore* _store;
+        uint32_t _archetype;
+        uint8_t* _data;
+    };
+
+    ArchetypeStore(const InitParams& params,
+                   const Allocator& allocator=Allocator());
+    ~ArchetypeStore();
+
+    /**
+     * Registers a component type.  Registering the same type twice returns
+     * the original id.
+     *
+     * @return The type's id, or kInvalidComponentType if the type limit
+     *         was reached
+     */
+    template<typename T> ComponentTypeId registerComponent();
+    /** @return The id of a registered type, or kInvalidComponentType */
+    template<typename T> ComponentTypeId componentType() const;
+    /** @return Size in bytes of a registered component type */
+    uint32_t componentSize(ComponentTypeId type) const;
+    /** @return Number of registered component types */
+    uint32_t componentTypeCount() const { return (uint32_t)_types.size(); }
+
+    /**
+     * Adds an entity without components.  Entities are also inserted
+     * implicitly when their first component is added.
+     */
+    void insert(Entity eid);
+    /** Removes an entity and all of its components */
+    void erase(Entity eid);
+    /** @return True if the entity is in the store */
+    bool contains(Entity eid) const;
+
+    /**
+     * Adds a zero-filled component to the entity, moving the entity to its
+     * new archetype.  If the entity already has the component, its value
+     * is kept.
+     *
+     * @return Pointer to the component, valid until the entity moves or
+     *         another entity of its archetype is removed
+     */
+    void* add(Entity eid, ComponentTypeId type);
+    /** Adds a component and copies value into it */
+    template<typename T> T* add(Entity eid, const T& value);
+    /** Removes a component, moving the entity to its new archetype */
+    bool remove(Entity eid, ComponentTypeId type);
+    template<typename T> bool remove(Entity eid) {
+        return remove(eid, componentType<T>());
+    }
+    /** @return The entity's component, or nullptr */
+    void* get(Entity eid, ComponentTypeId type) const;
+    template<typename T> T* get(Entity eid) const {
+        return reinterpret_cast<T*>(get(eid, componentType<T>()));
+    }
+    /** @return The component types owned by an entity */
+    ComponentSignature signature(Entity eid) const;
+
+    /** @return Number of entities in the store */
+    uint32_t size() const { return _entityCount; }
+    /** @return Number of archetypes created */
+    uint32_t archetypeCount() const { return (uint32_t)_archetypes.size(); }
+    /** @return The component types of an archetype */
+    const ComponentSignature& archetypeSignature(uint32_t archetype) const;
+    /** @return Number of chunks allocated for an archetype */
+    uint32_t archetypeChunkCount(uint32_t archetype) const;
+    /** @return Number of rows in each of an archetype's chunks */
+    uint32_t archetypeChunkCapacity(uint32_t archetype) const;
+    /** @return A view of an archetype's chunk */
+    Chunk archetypeChunk(uint32_t archetype, uint32_t chunk) const;
+
+    /**
+     * Invokes fn(const Chunk&) for every non-empty chunk whose archetype
+     * includes all types in required.
+     */
+    template<typename Fn>
+    void forEachChunk(const ComponentSignature& required, Fn&& fn) const;
+    /**
+     * Invokes fn(Entity, Ts&...) for every entity owning all of Ts.  The
+     * store must not be structurally modified by fn.
+     */
+    template<typename... Ts, typename Fn> void forEach(Fn&& fn);
+
+    /**
+     * Registers a cached query.  The query's matching archetypes are found
+     * once, and archetypes created later are tested as they appear, so
+     * running a query never scans unrelated archetypes.  Entities join and
+     * leave the results as components are added and removed, since they
+     * move between archetypes.  Registering an identical query returns the
+     * existing id.
+     *
+     * @param  query    The required and excluded component types
+     * @return The query's id
+     */
+    QueryId registerQuery(const ComponentQuery& query);
+    /** @return The masks of a registered query */
+    const ComponentQuery& query(QueryId id) const { return _queries[id].query; }
+    /** @return Number of entities matching a registered query */
+    uint32_t queryEntityCount(QueryId id) const;
+    /** Invokes fn(const Chunk&) for every non-empty chunk matching a query */
+    template<typename Fn> void forEachChunk(QueryId id, Fn&& fn) const;
+    /**
+     * Invokes fn(Entity, Ts&...) for every entity matching a query.  The
+     * query must require each of Ts.
+     */
+    template<typename... Ts, typename Fn> void forEach(QueryId id, Fn&& fn);
+
+private:
+    static constexpr uint32_t kChunkHeaderSize = kChunkAlign;
+    static constexpr uint8_t kNoColumn = 0xff;
+
+    struct ComponentInfo
+    {
+        const void* key;
+        uint32_t size;
+        uint32_t align;
+    };
+
+    struct Archetype
+    {
+        ComponentSignature signature;
+        uint32_t capacity;
+        uint32_t entityCount;
+        vector<ComponentTypeId> types;
+        vector<uint32_t> offsets;
+        vector<uint8_t*> chunks;
+        //  archetypes reached by adding or removing a type, keyed by
+        //  (type << 1) | added
+        unordered_map<uint32_t, uint32_t> edges;
+        uint8_t columns[kComponentTypeLimit];
+
+        Archetype(const Allocator& allocator);
+    };
+
+    struct Query
+    {
+        ComponentQuery query;
+        vector<uint32_t> archetypes;
+    };
+
+    struct Location
+    {
+        Entity eid;
+        uint32_t archetype;
+        uint32_t chunk;
+        uint32_t row;
+    };
+
+    template<typename T> static const void* typeKey();
+    template<typename... Ts, typename Fn, size_t... Is>
+    static void forEachRow(const Chunk& chunk, const ComponentTypeId* types,
+                           Fn& fn, std::index_sequence<Is...>);
+    ComponentTypeId registerComponent(const void* key, uint32_t size,
+                                      uint32_t align);
+    ComponentTypeId findComponentType(const void* key) const;
+
+    const Location* locate(Entity eid) const;
+    uint32_t findArchetype(const ComponentSignature& signature);
+    uint32_t transition(uint32_t archetype, ComponentTypeId type, bool added);
+    void allocRow(Location& location, uint32_t archetype);
+    void freeRow(const Location& location);
+    void moveEntity(Location& location, uint32_t archetype);
+
+    Allocator _allocator;
+    vector<ComponentInfo> _types;
+    vector<Archetype*> _archetypes;
+    map<ComponentSignature, uint32_t> _archetypeIndex;
+    vector<Query> _queries;
+    vector<Location> _locations;
+    uint32_t _entityCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T> const void* ArchetypeStore::typeKey()
+{
+    static const char key = 0;
+    return &key;
+}
+
+template<typename T> ComponentTypeId ArchetypeStore::registerComponent()
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Archetype components must be trivially copyable");
+    static_assert(alignof(T) <= kChunkAlign,
+                  "Component alignment exceeds the chunk's alignment");
+    return registerComponent(typeKey<T>(), sizeof(T), alignof(T));
+}
+
+template<typename T> ComponentTypeId ArchetypeStore::componentType() const
+{
+    return findComponentType(typeKey<T>());
+}
+
+template<typename T> T* ArchetypeStore::add(Entity eid, const T& value)
+{
+    ComponentTypeId type = componentType<T>();
+    CK_ASSERT_RETURN_VALUE(type != kInvalidComponentType, nullptr);
+    T* component = reinterpret_cast<T*>(add(eid, type));
+    if (component)
+        *component = value;
+    return component;
+}
+
+template<typename Fn>
+void ArchetypeStore::forEachChunk(const ComponentSignature& required, Fn&& fn) const
+{
+    for (uint32_t a = 0; a < _archetypes.size(); ++a)
+    {
+        const Archetype& archetype = *_archetypes[a];
+        if (!archetype.entityCount || !archetype.signature.contains(required))
+            continue;
+        for (uint8_t* data : archetype.chunks)
+            fn(Chunk(this, a, data));
+    }
+}
+
+template<typename Fn>
+void ArchetypeStore::forEachChunk(QueryId id, Fn&& fn) const
+{
+    for (uint32_t a : _queries[id].archetypes)
+    {
+        const Archetype& archetype = *_archetypes[a];
+        if (!archetype.entityCount)
+            continue;
+        for (uint8_t* data : archetype.chunks)
+            fn(Chunk(this, a, data));
+    }
+}
+
+template<typename... Ts, typename Fn> void ArchetypeStore::forEach(Fn&& fn)
+{
+    const ComponentTypeId types[] = { componentType<Ts>()... };
+    ComponentSignature required;
+    for (ComponentTypeId type : types)
+    {
+        CK_ASSERT_RETURN(type != kInvalidComponentType);
+        required.set(type);
+    }
+
+    forEachChunk(required, [&](const Chunk& chunk) {
+        forEachRow<Ts...>(chunk, types, fn, std::index_sequence_for<Ts...>());
+    });
+}
+
+template<typename... Ts, typename Fn>
+void ArchetypeStore::forEach(QueryId id, Fn&& fn)
+{
+    const ComponentTypeId types[] = { componentType<Ts>()... };
+    for (ComponentTypeId type : types)
+    {
+        CK_ASSERT_RETURN(type != kInvalidComponentType &&
+                         _queries[id].query.required.test(type));
+    }
+
+    forEachChunk(id, [&](const Chunk& chunk) {
+        forEachRow<Ts...>(chunk, types, fn, std::index_sequence_for<Ts...>());
+    });
+}
+
+template<typename... Ts, typename Fn, size_t... Is>
+void ArchetypeStore::forEachRow
+(
+    const Chunk& chunk,
+    const ComponentTypeId* types,
+    Fn& fn,
+    std::index_sequence<Is...>
+)
+{
+    const uint32_t count = chunk.size();
+    const Entity* entities = chunk.entities();
+    void* columns[] = { chunk.column(types[Is])... };
+    for (uint32_t row = 0; row < count; ++row)
+        fn(entities[row], reinterpret_cast<Ts*>(columns[Is])[row]...);
+}
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/componentsignature.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Component type bitsets and query masks
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_COMPONENT_SIGNATURE_HPP
+#define CINEK_COMPONENT_SIGNATURE_HPP
+
+#include "entity.h"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CINEK_SIGNATURE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CINEK_SIGNATURE_NEON 1
+#endif
+
+namespace cinek {
+
+using ComponentTypeId = uint32_t;
+
+/**
+ *  @struct ComponentSignature
+ *  @brief  A set of component types, one bit per ComponentTypeId
+ *
+ *  The set fits a single 128-bit vector register, so matching a signature
+ *  against a query's masks is a few SIMD instructions where available.
+ */
+struct alignas(16) ComponentSignature
+{
+    enum
+    {
+        kWordCount = 2,
+        kTypeLimit = kWordCount * 64
+    };
+
+    uint64_t words[kWordCount];
+
+    ComponentSignature() : words() {}
+
+    void set(ComponentTypeId type) { words[type >> 6] |= (uint64_t)1 << (type & 63); }
+    void reset(ComponentTypeId type) { words[type >> 6] &= ~((uint64_t)1 << (type & 63)); }
+    bool test(ComponentTypeId type) const {
+        return (words[type >> 6] & ((uint64_t)1 << (type & 63))) != 0;
+    }
+    bool empty() const { return !(words[0] | words[1]); }
+    /** @return True if every type in other is also in this signature */
+    bool contains(const ComponentSignature& other) const {
+        return matches(other, ComponentSignature());
+    }
+    /**
+     * @return True if this signature has every type in required and none
+     *         of the types in excluded
+     */
+    bool matches(const ComponentSignature& required,
+                 const ComponentSignature& excluded) const;
+
+    friend bool operator==(const ComponentSignature& l, const ComponentSignature& r) {
+        return l.words[0] == r.words[0] && l.words[1] == r.words[1];
+    }
+    friend bool operator!=(const ComponentSignature& l, const ComponentSignature& r) {
+        return !(l == r);
+    }
+    friend bool operator<(const ComponentSignature& l, const ComponentSignature& r) {
+        return l.words[1] < r.words[1] ||
+               (l.words[1] == r.words[1] && l.words[0] < r.words[0]);
+    }
+};
+
+static_assert(sizeof(ComponentSignature) == 16,
+              "ComponentSignature must fit a 128-bit register");
+
+/**
+ *  @struct ComponentQuery
+ *  @brief  Selects entities owning all required and no excluded types
+ */
+struct ComponentQuery
+{
+    ComponentSignature required;
+    ComponentSignature excluded;
+
+    ComponentQuery& with(ComponentTypeId type) { required.set(type); return *this; }
+    ComponentQuery& without(ComponentTypeId type) { excluded.set(type); return *this; }
+
+    bool matches(const ComponentSignature& signature) const {
+        return signature.matches(required, excluded);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline bool ComponentSignature::matches
+(
+    const ComponentSignature& required,
+    const ComponentSignature& excluded
+) const
+{
+#if CINEK_SIGNATURE_SSE2
+    __m128i sig = _mm_load_si128(reinterpret_cast<const __m128i*>(words));
+    __m128i req = _mm_load_si128(reinterpret_cast<const __m128i*>(required.words));
+    __m128i exc = _mm_load_si128(reinterpret_cast<const __m128i*>(excluded.words));
+    //  (sig & req) == req  and  (sig & exc) == 0
+    __m128i missing = _mm_andnot_si128(sig, req);
+    __m128i present = _mm_and_si128(sig, exc);
+    __m128i fail = _mm_or_si128(missing, present);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(fail, _mm_setzero_si128())) == 0xffff;
+#elif CINEK_SIGNATURE_NEON
+    uint64x2_t sig = vld1q_u64(words);
+    uint64x2_t missing = vbicq_u64(vld1q_u64(required.words), sig);
+    uint64x2_t present = vandq_u64(sig, vld1q_u64(excluded.words));
+    uint64x2_t fail = vorrq_u64(missing, present);
+    return !(vgetq_lane_u64(fail, 0) | vgetq_lane_u64(fail, 1));
+#else
+    uint64_t fail = 0;
+    for (int i = 0; i < kWordCount; ++i)
+        fail |= (required.words[i] & ~words[i]) | (words[i] & excluded.words[i]);
+    return !fail;
+#endif
+}
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,551 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/componenttable.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Sparse-set component storage keyed by entity index
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_COMPONENT_TABLE_HPP
+#define CINEK_COMPONENT_TABLE_HPP
+
+#include "entity.h"
+
+#include "cinek/vector.hpp"
+#include "cinek/allocator.hpp"
+#include "cinek/debug.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace cinek {
+
+/**
+ *  @class  ComponentTableBase
+ *  @brief  Type-erased operations on a ComponentTable
+ */
+class ComponentTableBase
+{
+public:
+    virtual ~ComponentTableBase() {}
+
+    /** Removes the entity's component, returning true if one was removed */
+    virtual bool remove(Entity eid) = 0;
+    /** Removes all components */
+    virtual void clear() = 0;
+    /** @return Number of components */
+    virtual uint32_t size() const = 0;
+};
+
+/**
+ *  @class  ComponentTable
+ *  @brief  Stores one component of type T per entity as a sparse set
+ *
+ *  Components are packed into a dense array alongside the entity owning
+ *  each one, so iterating a component type is a linear scan.  A sparse
+ *  array indexed by cinek_entity_index maps entities to dense slots.  The
+ *  sparse array is split into pages allocated on first use, so tables of
+ *  rarely used components stay small even when entity indices are large.
+ *
+ *  Add, remove and lookup are O(1).  Removal moves the last component into
+ *  the removed slot, so pointers and dense indices into the table are
+ *  invalidated by add and remove.  Lookups compare the full entity id, so
+ *  stale ids of destroyed entities never find a recycled index's component.
+ *
+ *  Change tracking is optional.  When enabled, each component carries the
+ *  tick at which it last changed, and the table appends a record to a
+ *  change log the first time a component changes within a tick.  Changes
+ *  are made through add() and modify() - get() does not mark components.
+ *  A system remembers the tick returned by markTick() on each run, and on
+ *  its next run visits only components changed since then, doing work
+ *  proportional to the number of changes rather than to the table size.
+ */
+template<typename T>
+class ComponentTable : public ComponentTableBase
+{
+    CK_CLASS_NON_COPYABLE(ComponentTable);
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    enum
+    {
+        /** Number of entity indices covered by a sparse page */
+        kPageSize = 4096,
+        kPageShift = 12
+    };
+
+    ComponentTable();
+    /**
+     * @param reserve   Number of components to reserve in the dense arrays
+     * @param allocator Allocator for dense arrays and sparse pages
+     */
+    explicit ComponentTable(uint32_t reserve,
+                            const Allocator& allocator=Allocator());
+    ~ComponentTable() override;
+
+    ComponentTable(ComponentTable&& other);
+    ComponentTable& operator=(ComponentTable&& other);
+
+    /**
+     * Adds a component for the entity, constructed from args.  If the
+     * entity already has a component, it is replaced.
+     *
+     * @param  eid  The owning entity
+     * @param  args Arguments passed to T's constructor
+     * @return Pointer to the component, valid until the next add or remove
+     */
+    template<typename... Args> T* add(Entity eid, Args&&... args);
+    /**
+     * Removes the entity's component, if any.
+     *
+     * @param  eid  The owning entity
+     * @return True if a component was removed
+     */
+    bool remove(Entity eid) override;
+    /** Removes all components, retaining memory */
+    void clear() override;
+    /**
+     * Replaces the table's contents with copies of parallel arrays, i.e.
+     * from a snapshot.
+     *
+     * @param entities  The owning entities
+     * @param values    The components
+     * @param count     Number of entries in each array
+     */
+    void assign(const Entity* entities, const T* values, uint32_t count);
+
+    /** @return The entity's component, or nullptr if it has none */
+    T* get(Entity eid);
+    /**
+     * Returns the entity's component for modification, marking it changed
+     * if change tracking is enabled.
+     *
+     * @return The entity's component, or nullptr if it has none
+     */
+    T* modify(Entity eid);
+    /** @return The entity's component, or nullptr if it has none */
+    const T* get(Entity eid) const;
+    /** @return True if the entity has a component in this table */
+    bool has(Entity eid) const { return denseIndex(eid) != kInvalidIndex; }
+
+    /** @return Number of components */
+    uint32_t size() const override { return (uint32_t)_values.size(); }
+    bool empty() const { return _values.empty(); }
+
+    /** @return Dense array of components, of length size() */
+    T* data() { return _values.data(); }
+    const T* data() const { return _values.data(); }
+    /** @return Dense array of owning entities, parallel to data() */
+    const Entity* entities() const { return _entities.data(); }
+    /** @return The entity owning the component at a dense index */
+    Entity entity(uint32_t index) const { return _entities[index]; }
+
+    iterator begin() { return _values.data(); }
+    iterator end() { return _values.data() + _values.size(); }
+    const_iterator begin() const { return _values.data(); }
+    const_iterator end() const { return _values.data() + _values.size(); }
+
+    /**
+     * Invokes fn(Entity, T&) for each component in dense order.  The table
+     * must not be modified by fn.
+     */
+    template<typename Fn> void forEach(Fn&& fn);
+
+    /** Enables or disables change tracking, discarding tracked changes */
+    void setChangeTracking(bool enabled);
+    bool isChangeTracking() const { return _tracking; }
+    /** @return The tick stamped on components changed from now on */
+    uint32_t tick() const { return _tick; }
+    /**
+     * Ends the current tick, so that later changes are stamped with a
+     * newer one.  A system calls this on each run, and passes the result
+     * to changedSince() on its next run.
+     *
+     * @return The tick that was ended
+     */
+    uint32_t markTick() { return _tick++; }
+    /** @return The tick at which the entity's component last changed, or
+     *          zero if untracked or absent */
+    uint32_t changeTick(Entity eid) const;
+    /**
+     * Invokes fn(Entity, T&) once for each component changed after the
+     * given tick that is still in the table.  The table must not be
+     * modified by fn, including through modify().
+     *
+     * @param  tick A tick returned by markTick(), or zero for all changes
+     *              still in the log
+     * @return Number of components visited
+     */
+    template<typename Fn> uint32_t changedSince(uint32_t tick, Fn&& fn);
+    /**
+     * Discards change records at or before a tick - i.e. the oldest tick
+     * any system will still ask for.
+     */
+    void trimChanges(uint32_t tick);
+    /** @return Number of records in the change log */
+    uint32_t changeLogSize() const { return (uint32_t)_changes.size(); }
+
+private:
+    static const uint32_t kInvalidIndex = 0xffffffff;
+    static const uint32_t kVisitedTick = 0x80000000;
+
+    struct ChangeRecord
+    {
+        Entity eid;
+        uint32_t tick;
+    };
+
+    uint32_t denseIndex(Entity eid) const;
+    void markChanged(uint32_t dense);
+    uint32_t* acquireSlot(EntityIndexType index);
+    void freePages();
+
+    Allocator _allocator;
+    //  pages of dense indices, indexed by entity index
+    vector<uint32_t*> _pages;
+    vector<Entity> _entities;
+    vector<T> _values;
+    //  change ticks parallel to the dense arrays, when tracking
+    vector<uint32_t> _ticks;
+    vector<ChangeRecord> _changes;
+    uint32_t _tick;
+    bool _tracking;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+ComponentTable<T>::ComponentTable() :
+    _tick(1),
+    _tracking(false)
+{
+}
+
+template<typename T>
+ComponentTable<T>::ComponentTable
+(
+    uint32_t reserve,
+    const Allocator& allocator
+) :
+    _allocator(allocator),
+    _pages(allocator),
+    _entities(allocator),
+    _values(allocator),
+    _ticks(allocator),
+    _changes(allocator),
+    _tick(1),
+    _tracking(false)
+{
+    _entities.reserve(reserve);
+    _values.reserve(reserve);
+}
+
+template<typename T>
+ComponentTable<T>::~ComponentTable()
+{
+    freePages();
+}
+
+template<typename T>
+ComponentTable<T>::ComponentTable(ComponentTable&& other) :
+    _allocator(std::move(other._allocator)),
+    _pages(std::move(other._pages)),
+    _entities(std::move(other._entities)),
+    _values(std::move(other._values)),
+    _ticks(std::move(other._ticks)),
+    _changes(std::move(other._changes)),
+    _tick(other._tick),
+    _tracking(other._tracking)
+{
+    other._pages.clear();
+}
+
+template<typename T>
+ComponentTable<T>& ComponentTable<T>::operator=(ComponentTable&& other)
+{
+    freePages();
+    _allocator = std::move(other._allocator);
+    _pages = std::move(other._pages);
+    _entities = std::move(other._entities);
+    _values = std::move(other._values);
+    _ticks = std::move(other._ticks);
+    _changes = std::move(other._changes);
+    _tick = other._tick;
+    _tracking = other._tracking;
+    other._pages.clear();
+    return *this;
+}
+
+template<typename T>
+void ComponentTable<T>::freePages()
+{
+    for (uint32_t* page : _pages)
+    {
+        if (page)
+            _allocator.free(page);
+    }
+    _pages.clear();
+}
+
+template<typename T>
+uint32_t ComponentTable<T>::denseIndex(Entity eid) const
+{
+    EntityIndexType index = cinek_entity_index(eid);
+    EntityIndexType pageIndex = index >> kPageShift;
+    if (pageIndex >= _pages.size() || !_pages[pageIndex])
+        return kInvalidIndex;
+    uint32_t dense = _pages[pageIndex][index & (kPageSize-1)];
+    if (dense == kInvalidIndex || _entities[dense] != eid)
+        return kInvalidIndex;
+    return dense;
+}
+
+template<typename T>
+uint32_t* ComponentTable<T>::acquireSlot(EntityIndexType index)
+{
+    EntityIndexType pageIndex = index >> kPageShift;
+    if (pageIndex >= _pages.size())
+        _pages.resize(pageIndex+1, nullptr);
+
+    uint32_t*& page = _pages[pageIndex];
+    if (!page)
+    {
+        page = reinterpret_cast<uint32_t*>(
+            _allocator.alloc(kPageSize * sizeof(uint32_t)));
+        if (!page)
+            return nullptr;
+        memset(page, 0xff, kPageSize * sizeof(uint32_t));
+    }
+    return &page[index & (kPageSize-1)];
+}
+
+template<typename T>
+template<typename... Args>
+T* ComponentTable<T>::add(Entity eid, Args&&... args)
+{
+    uint32_t* slot = acquireSlot(cinek_entity_index(eid));
+    CK_ASSERT_RETURN_VALUE(slot, nullptr);
+
+    if (*slot != kInvalidIndex)
+    {
+        //  the index may belong to a stale entity whose component was
+        //  never removed - the new entity takes over the slot
+        _entities[*slot] = eid;
+        _values[*slot] = T(std::forward<Args>(args)...);
+        markChanged(*slot);
+        return &_values[*slot];
+    }
+
+    *slot = (uint32_t)_values.size();
+    _entities.push_back(eid);
+    _values.emplace_back(std::forward<Args>(args)...);
+    if (_tracking)
+    {
+        _ticks.push_back(0);
+        markChanged(*slot);
+    }
+    return &_values.back();
+}
+
+template<typename T>
+bool ComponentTable<T>::remove(Entity eid)
+{
+    uint32_t dense = denseIndex(eid);
+    if (dense == kInvalidIndex)
+        return false;
+
+    uint32_t last = (uint32_t)_values.size() - 1;
+    if (dense != last)
+    {
+        Entity moved = _entities[last];
+        _entities[dense] = moved;
+        _values[dense] = std::move(_values[last]);
+        if (_tracking)
+            _ticks[dense] = _ticks[last];
+        EntityIndexType movedIndex = cinek_entity_index(moved);
+        _pages[movedIndex >> kPageShift][movedIndex & (kPageSize-1)] = dense;
+    }
+    _entities.pop_back();
+    _values.pop_back();
+    if (_tracking)
+        _ticks.pop_back();
+
+    EntityIndexType index = cinek_entity_index(eid);
+    _pages[index >> kPageShift][index & (kPageSize-1)] = kInvalidIndex;
+    return true;
+}
+
+template<typename T>
+void ComponentTable<T>::clear()
+{
+    for (Entity eid : _entities)
+    {
+        EntityIndexType index = cinek_entity_index(eid);
+        _pages[index >> kPageShift][index & (kPageSize-1)] = kInvalidIndex;
+    }
+    _entities.clear();
+    _values.clear();
+    _ticks.clear();
+    _changes.clear();
+}
+
+template<typename T>
+void ComponentTable<T>::assign(const Entity* entities, const T* values, uint32_t count)
+{
+    clear();
+    _entities.assign(entities, entities + count);
+    _values.assign(values, values + count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t* slot = acquireSlot(cinek_entity_index(entities[i]));
+        CK_ASSERT(slot);
+        if (slot)
+            *slot = i;
+    }
+    if (_tracking)
+    {
+        _ticks.resize(count, 0);
+        for (uint32_t i = 0; i < count; ++i)
+            markChanged(i);
+    }
+}
+
+template<typename T>
+T* ComponentTable<T>::get(Entity eid)
+{
+    uint32_t dense = denseIndex(eid);
+    return dense != kInvalidIndex ? &_values[dense] : nullptr;
+}
+
+template<typename T>
+const T* ComponentTable<T>::get(Entity eid) const
+{
+    uint32_t dense = denseIndex(eid);
+    return dense != kInvalidIndex ? &_values[dense] : nullptr;
+}
+
+template<typename T>
+T* ComponentTable<T>::modify(Entity eid)
+{
+    uint32_t dense = denseIndex(eid);
+    if (dense == kInvalidIndex)
+        return nullptr;
+    markChanged(dense);
+    return &_values[dense];
+}
+
+template<typename T>
+void ComponentTable<T>::markChanged(uint32_t dense)
+{
+    //  logged once per tick - later changes in the same tick are covered
+    //  by the existing record
+    if (!_tracking || _ticks[dense] == _tick)
+        return;
+    _ticks[dense] = _tick;
+    ChangeRecord record = { _entities[dense], _tick };
+    _changes.push_back(record);
+}
+
+template<typename T>
+void ComponentTable<T>::setChangeTracking(bool enabled)
+{
+    _tracking = enabled;
+    _changes.clear();
+    _ticks.clear();
+    if (enabled)
+        _ticks.resize(_values.size(), 0);
+}
+
+template<typename T>
+uint32_t ComponentTable<T>::changeTick(Entity eid) const
+{
+    uint32_t dense = denseIndex(eid);
+    if (!_tracking || dense == kInvalidIndex)
+        return 0;
+    return _ticks[dense];
+}
+
+template<typename T>
+template<typename Fn>
+uint32_t ComponentTable<T>::changedSince(uint32_t tick, Fn&& fn)
+{
+    //  records are appended in tick order
+    auto it = std::upper_bound(_changes.begin(), _changes.end(), tick,
+        [](uint32_t t, const ChangeRecord& record) {
+            return t < record.tick;
+        });
+
+    //  a component changed in several ticks has a record for each, and
+    //  only the one matching its latest tick is visited.  visited entries
+    //  are flagged so that a component removed and added again within a
+    //  tick isn't visited twice.
+    const auto first = it;
+    uint32_t count = 0;
+    for (; it != _changes.end(); ++it)
+    {
+        uint32_t dense = denseIndex(it->eid);
+        if (dense == kInvalidIndex || _ticks[dense] != it->tick)
+            continue;
+        _ticks[dense] |= kVisitedTick;
+        fn(it->eid, _values[dense]);
+        ++count;
+    }
+    for (it = first; it != _changes.end(); ++it)
+    {
+        uint32_t dense = denseIndex(it->eid);
+        if (dense != kInvalidIndex)
+            _ticks[dense] &= ~kVisitedTick;
+    }
+    return count;
+}
+
+template<typename T>
+void ComponentTable<T>::trimChanges(uint32_t tick)
+{
+    auto it = std::upper_bound(_changes.begin(), _changes.end(), tick,
+        [](uint32_t t, const ChangeRecord& record) {
+            return t < record.tick;
+        });
+    _changes.erase(_changes.begin(), it);
+}
+
+template<typename T>
+template<typename Fn>
+void ComponentTable<T>::forEach(Fn&& fn)
+{
+    const uint32_t count = (uint32_t)_values.size();
+    const Entity* entities = _entities.data();
+    T* values = _values.data();
+    for (uint32_t i = 0; i < count; ++i)
+        fn(entities[i], values[i]);
+}
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/entitycommandbuffer.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Records structural entity changes for deferred playback
+ * @copyright Cinekine
+ */
+
+#include "entitycommandbuffer.hpp"
+
+#include "cinek/debug.h"
+
+#include <algorithm>
+
+namespace cinek {
+
+EntityCommandBuffer::EntityCommandBuffer
+(
+    EntityStore& store,
+    size_t blockSize,
+    const Allocator& allocator
+) :
+    _store(store),
+    _memory(blockSize, allocator),
+    _head(nullptr),
+    _tail(nullptr),
+    _commandCount(0),
+    _sortKey(0)
+{
+}
+
+Entity EntityCommandBuffer::create(EntityContextType context)
+{
+    return _store.reserve(context);
+}
+
+void EntityCommandBuffer::destroy(Entity eid)
+{
+    record(kDestroy, eid, nullptr, nullptr, 0);
+}
+
+void EntityCommandBuffer::clear()
+{
+    _memory.reset();
+    _head = _tail = nullptr;
+    _commandCount = 0;
+}
+
+auto EntityCommandBuffer::record
+(
+    Op op,
+    Entity eid,
+    void* table,
+    ApplyFn apply,
+    size_t payloadSize
+) -> Command*
+{
+    //  keep every record a multiple of the command's alignment, so that
+    //  records and payloads packed in the stack stay aligned
+    size_t size = sizeof(Command) + CK_ALIGN_SIZE(payloadSize, alignof(Command));
+    Command* command = reinterpret_cast<Command*>(_memory.allocate(size));
+    if (!command)
+    {
+        CK_LOG_ERROR("EntityCommandBuffer", "Out of command memory");
+        return nullptr;
+    }
+    command->next = nullptr;
+    command->eid = eid;
+    command->table = table;
+    command->apply = apply;
+    command->sortKey = _sortKey;
+    command->op = op;
+
+    if (_tail)
+        _tail->next = command;
+    else
+        _head = command;
+    _tail = command;
+    ++_commandCount;
+    return command;
+}
+
+void EntityCommandBuffer::playback
+(
+    EntityCommandBuffer* const* buffers,
+    uint32_t bufferCount,
+    ComponentTableBase* const* tables,
+    uint32_t tableCount
+)
+{
+    if (!bufferCount)
+        return;
+
+    EntityStore& store = buffers[0]->_store;
+    uint32_t commandCount = 0;
+    for (uint32_t b = 0; b < bufferCount; ++b)
+    {
+        CK_ASSERT_RETURN(&buffers[b]->_store == &store);
+        commandCount += buffers[b]->_commandCount;
+    }
+
+    //  gathered in buffer and recording order, so the stable sort by key
+    //  yields the same sequence however work was spread across buffers
+    vector<Command*> commands(buffers[0]->_memory.allocator());
+    commands.reserve(commandCount);
+    for (uint32_t b = 0; b < bufferCount; ++b)
+    {
+        for (Command* command = buffers[b]->_head; command; command = command->next)
+            commands.push_back(command);
+    }
+    //  commands on entities destroyed since recording are dropped
+    commands.erase(std::remove_if(commands.begin(), commands.end(),
+        [&store](const Command* command) {
+            return !store.valid(command->eid);
+        }), commands.end());
+    std::stable_sort(commands.begin(), commands.end(),
+        [](const Command* l, const Command* r) {
+            return l->sortKey < r->sortKey;
+        });
+
+    //  destroys are applied last, after partitioning them out in order
+    auto componentEnd = std::stable_partition(commands.begin(), commands.end(),
+        [](const Command* command) {
+            return command->op != kDestroy;
+        });
+
+    //  group component commands by table - each table's commands keep
+    //  their relative order, and tables don't affect one another
+    std::stable_sort(commands.begin(), componentEnd,
+        [](const Command* l, const Command* r) {
+            return std::less<void*>()(l->table, r->table);
+        });
+    for (auto it = commands.begin(); it != componentEnd; )
+    {
+        auto batchEnd = it + 1;
+        while (batchEnd != componentEnd && (*batchEnd)->table == (*it)->table)
+            ++batchEnd;
+        (*it)->apply((*it)->table, &*it, (uint32_t)(batchEnd - it));
+        it = batchEnd;
+    }
+
+    if (componentEnd != commands.end())
+    {
+        vector<Entity> destroyed(buffers[0]->_memory.allocator());
+        destroyed.reserve(commands.end() - componentEnd);
+        for (auto it = componentEnd; it != commands.end(); ++it)
+            destroyed.push_back((*it)->eid);
+        for (uint32_t t = 0; t < tableCount; ++t)
+        {
+            for (Entity eid : destroyed)
+                tables[t]->remove(eid);
+        }
+        store.destroyBatch(destroyed.data(), (uint32_t)destroyed.size());
+    }
+
+    for (uint32_t b = 0; b < bufferCount; ++b)
+        buffers[b]->clear();
+}
+
+} /* namespace cinek */
@@ -0,0 +1,191 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/entitycommandbuffer.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Records structural entity changes for deferred playback
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_ENTITY_COMMAND_BUFFER_HPP
+#define CINEK_ENTITY_COMMAND_BUFFER_HPP
+
+#include "entitystore.hpp"
+#include "componenttable.hpp"
+
+#include "cinek/memorystack.hpp"
+
+#include <type_traits>
+
+namespace cinek {
+
+/**
+ *  @class  EntityCommandBuffer
+ *  @brief  Records entity and component changes made by parallel systems
+ *
+ *  Systems running on worker threads can't modify an EntityStore or its
+ *  component tables directly.  Instead each thread records changes into
+ *  its own command buffer, and the buffers are played back together at a
+ *  sync point on the owning thread.  Commands are allocated sequentially
+ *  from the buffer's MemoryStack, which is reset after playback.
+ *
+ *  Entities are created immediately with EntityStore::reserve, so a new
+ *  id can be used by later commands.  Destroy, add and remove commands
+ *  are deferred.
+ *
+ *  Playback order is deterministic regardless of which thread recorded
+ *  which commands, so long as work is tagged with setSortKey() (i.e. with
+ *  the index of the job or chunk being processed.)  Commands are ordered
+ *  by sort key, then by buffer, then by recording order, and component
+ *  commands are then grouped by table so that each table is updated in a
+ *  single batch.  Destroyed entities have their components removed from
+ *  the tables passed to playback.
+ *
+ *  Components recorded by add() must be trivially copyable.
+ */
+class EntityCommandBuffer
+{
+    CK_CLASS_NON_COPYABLE(EntityCommandBuffer);
+
+public:
+    /**
+     * @param store     The store whose entities are modified
+     * @param blockSize Size of each block of command memory
+     * @param allocator Allocator for command memory
+     */
+    EntityCommandBuffer(EntityStore& store, size_t blockSize=16*1024,
+                        const Allocator& allocator=Allocator());
+
+    /** Sets the sort key applied to subsequently recorded commands */
+    void setSortKey(uint32_t key) { _sortKey = key; }
+    /** Creates an entity, valid immediately */
+    Entity create(EntityContextType context=0);
+    /** Records the destruction of an entity */
+    void destroy(Entity eid);
+    /** Records adding (or replacing) an entity's component */
+    template<typename T> void add(ComponentTable<T>& table, Entity eid,
+                                  const T& value);
+    /** Records removing an entity's component */
+    template<typename T> void remove(ComponentTable<T>& table, Entity eid);
+
+    /** @return Number of recorded commands */
+    uint32_t commandCount() const { return _commandCount; }
+    /** Discards recorded commands */
+    void clear();
+
+    /**
+     * Applies commands from a set of buffers and clears the buffers.  The
+     * buffers must share one EntityStore.
+     *
+     * @param buffers       The buffers, in playback order
+     * @param bufferCount   Number of buffers
+     * @param tables        Tables cleaned of destroyed entities' components
+     * @param tableCount    Number of tables
+     */
+    static void playback(EntityCommandBuffer* const* buffers,
+                         uint32_t bufferCount,
+                         ComponentTableBase* const* tables,
+                         uint32_t tableCount);
+
+private:
+    enum Op
+    {
+        kDestroy,
+        kAdd,
+        kRemove
+    };
+
+    struct Command;
+    using ApplyFn = void (*)(void* table, Command* const* commands,
+                             uint32_t count);
+
+    struct alignas(16) Command
+    {
+        Command* next;
+        Entity eid;
+        void* table;
+        ApplyFn apply;
+        uint32_t sortKey;
+        Op op;
+
+        void* payload() { return this + 1; }
+    };
+
+    Command* record(Op op, Entity eid, void* table, ApplyFn apply,
+                    size_t payloadSize);
+    template<typename T> static void applyTo(void* table,
+                                             Command* const* commands,
+                                             uint32_t count);
+
+    EntityStore& _store;
+    MemoryStack _memory;
+    Command* _head;
+    Command* _tail;
+    uint32_t _commandCount;
+    uint32_t _sortKey;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+void EntityCommandBuffer::add(ComponentTable<T>& table, Entity eid, const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Recorded components must be trivially copyable");
+    static_assert(alignof(T) <= alignof(Command),
+                  "Component alignment exceeds the command's alignment");
+
+    Command* command = record(kAdd, eid, &table, &applyTo<T>, sizeof(T));
+    if (command)
+        memcpy(command->payload(), &value, sizeof(T));
+}
+
+template<typename T>
+void EntityCommandBuffer::remove(ComponentTable<T>& table, Entity eid)
+{
+    record(kRemove, eid, &table, &applyTo<T>, 0);
+}
+
+template<typename T>
+void EntityCommandBuffer::applyTo
+(
+    void* table,
+    Command* const* commands,
+    uint32_t count
+)
+{
+    ComponentTable<T>& components = *reinterpret_cast<ComponentTable<T>*>(table);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Command* command = commands[i];
+        if (command->op == kAdd)
+            components.add(command->eid, *reinterpret_cast<const T*>(command->payload()));
+        else
+            components.remove(command->eid);
+    }
+}
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/entitysnapshot.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Binary snapshots of entities and component tables
+ * @copyright Cinekine
+ */
+
+#include "entitysnapshot.hpp"
+
+#include "cinek/debug.h"
+
+#include <ostream>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CINEK_SNAPSHOT_MMAP 1
+#else
+#include <fstream>
+#endif
+
+namespace cinek {
+
+namespace {
+
+    const char kMagic[4] = { 'C', 'K', 'E', 'S' };
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entityBytes;
+        uint32_t iterationBytes;
+        uint32_t indexCount;
+        uint32_t freedCount;
+        uint32_t entityCount;
+        uint32_t tableCount;
+    };
+
+    struct TableHeader
+    {
+        uint32_t id;
+        uint32_t componentSize;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) % EntitySnapshot::kSectionAlign == 0,
+                  "Snapshot header must keep sections aligned");
+    static_assert(sizeof(TableHeader) % EntitySnapshot::kSectionAlign == 0,
+                  "Snapshot table header must keep sections aligned");
+
+    inline size_t padded(size_t size)
+    {
+        return CK_ALIGN_SIZE(size, (size_t)EntitySnapshot::kSectionAlign);
+    }
+
+    void writeSection(std::ostream& out, const void* data, size_t size)
+    {
+        static const char zeroes[EntitySnapshot::kSectionAlign] = { 0 };
+        out.write(reinterpret_cast<const char*>(data), size);
+        out.write(zeroes, padded(size) - size);
+    }
+
+    //  bounds-checked walk over an image's sections.  Section sizes are
+    //  computed in 64 bits so that counts read from an image can't wrap on
+    //  32-bit targets.
+    struct Reader
+    {
+        const uint8_t* data;
+        size_t size;
+        size_t offset;
+
+        const void* section(uint64_t bytes)
+        {
+            if (bytes > size - offset)
+                return nullptr;
+            size_t next = offset + padded((size_t)bytes);
+            if (next < offset || next > size)
+                return nullptr;
+            const void* p = data + offset;
+            offset = next;
+            return p;
+        }
+    };
+
+}
+
+EntitySnapshot::EntitySnapshot(const Allocator& allocator) :
+    _allocator(allocator),
+    _tables(allocator)
+{
+}
+
+bool EntitySnapshot::save(std::ostream& out, const EntityStore& store) const
+{
+    const uint32_t indexCount = store._indexCount.load(std::memory_order_relaxed);
+    const uint32_t freedHead = store._freedHead.load(std::memory_order_relaxed);
+    const uint32_t freedCount = (uint32_t)store._freed.size() - freedHead;
+
+    FileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entityBytes = sizeof(Entity);
+    header.iterationBytes = sizeof(EntityIterationType);
+    header.indexCount = indexCount;
+    header.freedCount = freedCount;
+    header.entityCount = store._entityCount.load(std::memory_order_relaxed);
+    header.tableCount = (uint32_t)_tables.size();
+
+    writeSection(out, &header, sizeof(header));
+    writeSection(out, store._iterations.data(),
+                 indexCount * sizeof(EntityIterationType));
+    writeSection(out, store._freed.data() + freedHead,
+                 freedCount * sizeof(EntityIndexType));
+
+    for (const Table& table : _tables)
+    {
+        TableHeader tableHeader;
+        tableHeader.id = table.id;
+        tableHeader.componentSize = table.componentSize;
+        tableHeader.count = table.count(table.table);
+        tableHeader.reserved = 0;
+
+        writeSection(out, &tableHeader, sizeof(tableHeader));
+        writeSection(out, table.entities(table.table),
+                     tableHeader.count * sizeof(Entity));
+        writeSection(out, table.values(table.table),
+                     (size_t)tableHeader.count * table.componentSize);
+    }
+    return (bool)out;
+}
+
+bool EntitySnapshot::load(const void* data, size_t size, EntityStore& store)
+{
+    Reader reader = { reinterpret_cast<const uint8_t*>(data), size, 0 };
+
+    const FileHeader* header =
+        reinterpret_cast<const FileHeader*>(reader.section(sizeof(FileHeader)));
+    if (!header || memcmp(header->magic, kMagic, sizeof(kMagic)))
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Not an entity snapshot");
+        return false;
+    }
+    if (header->version != kVersion ||
+        header->entityBytes != sizeof(Entity) ||
+        header->iterationBytes != sizeof(EntityIterationType))
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Incompatible snapshot (version %u, "
+                     "%u-byte entities)", header->version, header->entityBytes);
+        return false;
+    }
+
+    const EntityIterationType* iterations =
+        reinterpret_cast<const EntityIterationType*>(
+            reader.section((uint64_t)header->indexCount * sizeof(EntityIterationType)));
+    const EntityIndexType* freed =
+        reinterpret_cast<const EntityIndexType*>(
+            reader.section((uint64_t)header->freedCount * sizeof(EntityIndexType)));
+    if (!iterations || !freed)
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Truncated snapshot");
+        return false;
+    }
+    for (uint32_t i = 0; i < header->freedCount; ++i)
+    {
+        if (freed[i] >= header->indexCount)
+        {
+            CK_LOG_ERROR("EntitySnapshot", "Freed index %u out of range",
+                         freed[i]);
+            return false;
+        }
+    }
+    //  each table takes at least a header, which bounds the count before
+    //  reserving anything for it
+    if (header->tableCount > (size - reader.offset) / sizeof(TableHeader))
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Truncated snapshot");
+        return false;
+    }
+
+    //  validate every table section before modifying anything
+    struct Section
+    {
+        const TableHeader* header;
+        const Entity* entities;
+        const void* values;
+    };
+    vector<Section> sections(_allocator);
+    sections.reserve(header->tableCount);
+    for (uint32_t t = 0; t < header->tableCount; ++t)
+    {
+        Section section;
+        section.header = reinterpret_cast<const TableHeader*>(
+            reader.section(sizeof(TableHeader)));
+        if (!section.header)
+            break;
+        section.entities = reinterpret_cast<const Entity*>(
+            reader.section((uint64_t)section.header->count * sizeof(Entity)));
+        section.values = reader.section(
+            (uint64_t)section.header->count * section.header->componentSize);
+        if (!section.entities || !section.values)
+            break;
+        sections.push_back(section);
+    }
+    if (sections.size() != header->tableCount)
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Truncated snapshot");
+        return false;
+    }
+
+    //  each table's entities must be live in the image's store, and appear
+    //  once, since tables index their slots by entity index
+    vector<uint32_t> seen(_allocator);
+    seen.resize((header->indexCount + 31) / 32, 0);
+    for (const Section& section : sections)
+    {
+        for (uint32_t i = 0; i < section.header->count; ++i)
+        {
+            const Entity eid = section.entities[i];
+            const auto index = cinek_entity_index(eid);
+            if (index >= header->indexCount ||
+                iterations[index] != cinek_entity_iteration(eid) ||
+                (seen[index / 32] & (1u << (index % 32))))
+            {
+                CK_LOG_ERROR("EntitySnapshot", "Table %u has an invalid entity "
+                             "at row %u", section.header->id, i);
+                return false;
+            }
+            seen[index / 32] |= 1u << (index % 32);
+        }
+        for (uint32_t i = 0; i < section.header->count; ++i)
+        {
+            const auto index = cinek_entity_index(section.entities[i]);
+            seen[index / 32] &= ~(1u << (index % 32));
+        }
+    }
+
+    for (const Table& table : _tables)
+    {
+        for (const Section& section : sections)
+        {
+            if (section.header->id == table.id &&
+                section.header->componentSize != table.componentSize)
+            {
+                CK_LOG_ERROR("EntitySnapshot", "Table %u component size "
+                             "mismatch (%u != %u)", table.id,
+                             section.header->componentSize, table.componentSize);
+                return false;
+            }
+        }
+    }
+
+    //  adopt the store's arrays.  iterations beyond the index count keep
+    //  the preset first iteration that reservations rely on
+    size_t capacity = store._iterations.size();
+    store._iterations.assign(iterations, iterations + header->indexCount);
+    if (capacity > header->indexCount)
+        store._iterations.resize(capacity, 1);
+    store._indexCount.store(header->indexCount, std::memory_order_relaxed);
+    store._freed.assign(freed, freed + header->freedCount);
+    store._freedHead.store(0, std::memory_order_relaxed);
+    store._entityCount.store(header->entityCount, std::memory_order_relaxed);
+    store._destroyQueue.clear();
+
+    for (const Table& table : _tables)
+    {
+        const Section* match = nullptr;
+        for (const Section& section : sections)
+        {
+            if (section.header->id == table.id)
+            {
+                match = &section;
+                break;
+            }
+        }
+        if (match)
+        {
+            table.assign(table.table, match->entities, match->values,
+                         match->header->count);
+        }
+        else
+        {
+            table.assign(table.table, nullptr, nullptr, 0);
+        }
+    }
+    return true;
+}
+
+bool EntitySnapshot::loadFile(const char* path, EntityStore& store)
+{
+#if CINEK_SNAPSHOT_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Unable to open %s", path);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        CK_LOG_ERROR("EntitySnapshot", "Unable to read %s", path);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    void* image = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (image == MAP_FAILED)
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Unable to map %s", path);
+        return false;
+    }
+    bool result = load(image, size, store);
+    munmap(image, size);
+    return result;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        CK_LOG_ERROR("EntitySnapshot", "Unable to open %s", path);
+        return false;
+    }
+    size_t size = (size_t)in.tellg();
+    in.seekg(0);
+    void* image = _allocator.allocAligned(size, kSectionAlign);
+    if (!image)
+        return false;
+    in.read(reinterpret_cast<char*>(image), size);
+    bool result = in && load(image, size, store);
+    _allocator.freeAligned(image);
+    return result;
+#endif
+}
+
+} /* namespace cinek */
@@ -0,0 +1,160 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/entitysnapshot.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   Binary snapshots of entities and component tables
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_ENTITY_SNAPSHOT_HPP
+#define CINEK_ENTITY_SNAPSHOT_HPP
+
+#include "entitystore.hpp"
+#include "componenttable.hpp"
+
+#include <iosfwd>
+#include <type_traits>
+
+namespace cinek {
+
+/**
+ *  @class  EntitySnapshot
+ *  @brief  Saves and loads an EntityStore and its POD component tables
+ *
+ *  A snapshot is a versioned binary image of the store's iteration table,
+ *  its free index FIFO and counters, followed by the dense arrays of each
+ *  registered component table.  Sections are written as-is and padded to
+ *  16 bytes, so loading copies arrays straight out of the image (mapped
+ *  into memory with loadFile) without parsing any values.
+ *
+ *  Tables are identified by the id given at registration.  Tables in the
+ *  image without a registered counterpart are skipped, and registered
+ *  tables missing from the image are cleared.  Images written with a
+ *  different version, entity id width or component size are rejected.
+ */
+class EntitySnapshot
+{
+    CK_CLASS_NON_COPYABLE(EntitySnapshot);
+
+public:
+    enum
+    {
+        kVersion = 1,
+        kSectionAlign = 16
+    };
+
+    EntitySnapshot(const Allocator& allocator=Allocator());
+
+    /**
+     * Registers a table for saving and loading.
+     *
+     * @param id    A stable identifier for the table within snapshots
+     * @param table The table, which must outlive the snapshot object
+     */
+    template<typename T> void registerTable(uint32_t id, ComponentTable<T>& table);
+
+    /**
+     * Writes a snapshot, with one sequential run of writes per section.
+     *
+     * @param  out      The destination stream, opened in binary mode
+     * @param  store    The store to save
+     * @return False if the stream failed
+     */
+    bool save(std::ostream& out, const EntityStore& store) const;
+    /**
+     * Restores the store and registered tables from a snapshot image.
+     *
+     * @param  data     The image
+     * @param  size     Size of the image in bytes
+     * @param  store    The store to restore
+     * @return False if the image is invalid, in which case neither the
+     *         store nor the tables were modified
+     */
+    bool load(const void* data, size_t size, EntityStore& store);
+    /**
+     * Maps a snapshot file into memory and restores from it.
+     *
+     * @param  path     Path of the snapshot file
+     * @param  store    The store to restore
+     * @return False if the file could not be read or is invalid
+     */
+    bool loadFile(const char* path, EntityStore& store);
+
+private:
+    struct Table
+    {
+        uint32_t id;
+        uint32_t componentSize;
+        void* table;
+        uint32_t (*count)(const void* table);
+        const Entity* (*entities)(const void* table);
+        const void* (*values)(const void* table);
+        void (*assign)(void* table, const Entity* entities, const void* values,
+                       uint32_t count);
+    };
+
+    template<typename T> struct Thunks
+    {
+        static uint32_t count(const void* table) {
+            return reinterpret_cast<const ComponentTable<T>*>(table)->size();
+        }
+        static const Entity* entities(const void* table) {
+            return reinterpret_cast<const ComponentTable<T>*>(table)->entities();
+        }
+        static const void* values(const void* table) {
+            return reinterpret_cast<const ComponentTable<T>*>(table)->data();
+        }
+        static void assign(void* table, const Entity* entities,
+                           const void* values, uint32_t count) {
+            reinterpret_cast<ComponentTable<T>*>(table)->assign(
+                entities, reinterpret_cast<const T*>(values), count);
+        }
+    };
+
+    Allocator _allocator;
+    vector<Table> _tables;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+void EntitySnapshot::registerTable(uint32_t id, ComponentTable<T>& table)
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Snapshot components must be trivially copyable");
+    static_assert(alignof(T) <= kSectionAlign,
+                  "Component alignment exceeds the snapshot's alignment");
+
+    Table entry = {
+        id, sizeof(T), &table,
+        &Thunks<T>::count, &Thunks<T>::entities, &Thunks<T>::values,
+        &Thunks<T>::assign
+    };
+    _tables.push_back(entry);
+}
+
+} /* namespace cinek */
+
+#endif
@@ -28,7 +28,19 @@
 
 namespace cinek {
 
+namespace {
+
+    //  largest iteration that fits an entity id's iteration field - the
+    //  field is narrower than EntityIterationType in 32-bit ids
+    const EntityIterationType kIterationLimit =
+        (EntityIterationType)(kCKEntityIterationMask >> kCKEntityIterationShift);
+
+}
+
 EntityStore::EntityStore() :
+    _indexCount(0),
+    _freedHead(0),
+    _recycleDelay(0),
     _entityIdIteration(0),
     _entityCount(0)
 {
@@ -40,21 +52,31 @@ EntityStore::EntityStore
     const Allocator& allocator
 ) :
     _iterations(allocator),
+    _indexCount(0),
     _freed(allocator),
+    _freedHead(0),
+    _recycleDelay(params.recycleDelay),
+    _destroyQueue(allocator),
     _entityIdIteration(0),
     _entityCount(0)
 {
-    _iterations.reserve(params.numEntities);
+    _iterations.resize(params.numEntities, 1);
     _freed.reserve(params.numEntities);
 }
 
 
 EntityStore::EntityStore(EntityStore&& other) :
     _iterations(std::move(other._iterations)),
+    _indexCount(other._indexCount.load()),
     _freed(std::move(other._freed)),
+    _freedHead(other._freedHead.load()),
+    _recycleDelay(other._recycleDelay),
+    _destroyQueue(std::move(other._destroyQueue)),
     _entityIdIteration(other._entityIdIteration),
-    _entityCount(other._entityCount)
+    _entityCount(other._entityCount.load())
 {
+    other._indexCount = 0;
+    other._freedHead = 0;
     other._entityIdIteration = 0;
     other._entityCount = 0;
 }
@@ -62,10 +84,16 @@ EntityStore::EntityStore(EntityStore&& other) :
 EntityStore& EntityStore::operator=(EntityStore&& other)
 {
     _iterations = std::move(other._iterations);
+    _indexCount = other._indexCount.load();
     _freed = std::move(other._freed);
+    _freedHead = other._freedHead.load();
+    _recycleDelay = other._recycleDelay;
+    _destroyQueue = std::move(other._destroyQueue);
     _entityIdIteration = other._entityIdIteration;
-    _entityCount = other._entityCount;
+    _entityCount = other._entityCount.load();
     
+    other._indexCount = 0;
+    other._freedHead = 0;
     other._entityIdIteration = 0;
     other._entityCount = 0;
     
@@ -78,51 +106,195 @@ EntityStore::~EntityStore()
     
 Entity EntityStore::create(EntityContextType context)
 {
-    EntityIndexType index;
-    
-    if (!_freed.empty())
+    Entity eid = 0;
+    createBatch(1, context, &eid);
+    return eid;
+}
+
+void EntityStore::destroy(Entity eid)
+{
+    destroyBatch(&eid, 1);
+}
+
+Entity EntityStore::reserve(EntityContextType context)
+{
+    Entity eid = 0;
+    reserveBatch(1, context, &eid);
+    return eid;
+}
+
+uint32_t EntityStore::popFreed
+(
+    uint32_t count,
+    EntityContextType context,
+    Entity* out
+)
+{
+    //  recycle the oldest freed indices, keeping the newest in quarantine.
+    //  the FIFO itself only changes on the owning thread, so claiming a
+    //  range only needs to advance the head
+    const uint32_t freedSize = (uint32_t)_freed.size();
+    uint32_t head = _freedHead.load(std::memory_order_relaxed);
+    uint32_t recycled;
+    do
     {
-        index = _freed.back();
-        _freed.pop_back();
+        uint32_t freeCount = freedSize - head;
+        if (freeCount <= _recycleDelay)
+            return 0;
+        recycled = freeCount - _recycleDelay;
+        if (recycled > count)
+            recycled = count;
     }
-    else
+    while (!_freedHead.compare_exchange_weak(head, head + recycled,
+                                             std::memory_order_relaxed));
+
+    const EntityIndexType* indices = _freed.data() + head;
+    for (uint32_t i = 0; i < recycled; ++i)
     {
-        index = (EntityIndexType)_iterations.size();
-        _iterations.push_back(1);
+        EntityIndexType index = indices[i];
+        out[i] = cinek_make_entity(_iterations[index], context, index);
     }
-    
-    Entity eid = cinek_make_entity(_iterations[index], context, index);
-    ++_entityCount;
-    return eid;
+    return recycled;
 }
 
-void EntityStore::destroy(Entity eid)
+uint32_t EntityStore::claimFresh
+(
+    uint32_t count,
+    EntityContextType context,
+    Entity* out
+)
 {
-    if (eid==0)
-        return;
+    const EntityIndexType limit = (EntityIndexType)_iterations.size();
+    EntityIndexType first = _indexCount.load(std::memory_order_relaxed);
+    uint32_t claimed;
+    do
+    {
+        if (first >= limit)
+            return 0;
+        claimed = limit - first;
+        if (claimed > count)
+            claimed = count;
+    }
+    while (!_indexCount.compare_exchange_weak(first, first + claimed,
+                                              std::memory_order_relaxed));
 
-    auto index = cinek_entity_index(eid);
-    ++_iterations[index];
-    if (!_iterations[index])
-        _iterations[index] = 1;
+    for (uint32_t i = 0; i < claimed; ++i)
+    {
+        EntityIndexType index = first + i;
+        out[i] = cinek_make_entity(_iterations[index], context, index);
+    }
+    return claimed;
+}
 
-    --_entityCount;
+void EntityStore::compactFreed()
+{
+    //  compact once the consumed head dominates the queue
+    uint32_t head = _freedHead.load(std::memory_order_relaxed);
+    if (head == _freed.size())
+    {
+        _freed.clear();
+        _freedHead.store(0, std::memory_order_relaxed);
+    }
+    else if (head >= 1024 && head * 2 >= _freed.size())
+    {
+        _freed.erase(_freed.begin(), _freed.begin() + head);
+        _freedHead.store(0, std::memory_order_relaxed);
+    }
+}
 
-    _freed.push_back(index);
+uint32_t EntityStore::reserveBatch
+(
+    uint32_t count,
+    EntityContextType context,
+    Entity* out
+)
+{
+    uint32_t created = popFreed(count, context, out);
+    created += claimFresh(count - created, context, out + created);
+    _entityCount.fetch_add(created, std::memory_order_relaxed);
+    return created;
+}
+
+uint32_t EntityStore::createBatch
+(
+    uint32_t count,
+    EntityContextType context,
+    Entity* out
+)
+{
+    uint32_t created = popFreed(count, context, out);
+    compactFreed();
+
+    //  the remainder are fresh indices, growing capacity as needed
+    const uint64_t indexLimit = (uint64_t)kCKEntityIndexMask + 1;
+    uint64_t needed = (uint64_t)_indexCount.load(std::memory_order_relaxed) +
+                      (count - created);
+    if (needed > indexLimit)
+    {
+        CK_LOG_ERROR("EntityStore", "Entity index limit (%llu) reached",
+                     (unsigned long long)indexLimit);
+        needed = indexLimit;
+    }
+    if (needed > _iterations.size())
+    {
+        uint64_t size = (uint64_t)_iterations.size() * 2;
+        if (size < needed)
+            size = needed;
+        if (size > indexLimit)
+            size = indexLimit;
+        _iterations.resize((size_t)size, 1);
+    }
+    created += claimFresh(count - created, context, out + created);
+
+    _entityCount.fetch_add(created, std::memory_order_relaxed);
+    return created;
+}
+
+void EntityStore::destroyBatch(const Entity* eids, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Entity eid = eids[i];
+        if (eid==0 || !valid(eid))
+            continue;
+
+        auto index = cinek_entity_index(eid);
+        //  iterations wrap within the id's field, skipping zero so that
+        //  a recycled id is never the null entity
+        if (_iterations[index] >= kIterationLimit)
+            _iterations[index] = 1;
+        else
+            ++_iterations[index];
+
+        _entityCount.fetch_sub(1, std::memory_order_relaxed);
+
+        _freed.push_back(index);
+    }
+}
+
+void EntityStore::destroyDeferred(Entity eid)
+{
+    if (eid)
+        _destroyQueue.push_back(eid);
 }
 
 bool EntityStore::valid(Entity eid) const
 {
-    return (_iterations[cinek_entity_index(eid)] == cinek_entity_iteration(eid));
+    auto index = cinek_entity_index(eid);
+    return index < _indexCount.load(std::memory_order_relaxed) &&
+           _iterations[index] == cinek_entity_iteration(eid);
 }
 
 void EntityStore::gc()
 {
+    destroyBatch(_destroyQueue.data(), (uint32_t)_destroyQueue.size());
+    _destroyQueue.clear();
+    compactFreed();
 }
 
 void EntityStore::diagnostics(EntityDiagnostics& diagnostics)
 {
-    diagnostics.entityCount = _entityCount;
+    diagnostics.entityCount = _entityCount.load(std::memory_order_relaxed);
     diagnostics.entityLimit = (uint32_t)_iterations.capacity();
 }
 
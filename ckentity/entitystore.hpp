@@ -38,6 +38,7 @@
 #include "cinek/map.hpp"
 #include "cinek/allocator.hpp"
 
+#include <atomic>
 #include <random>
 #include <functional>
 
@@ -62,6 +63,11 @@ public:
     struct InitParams
     {
         EntityIndexType numEntities;
+        /** Number of freed indices held back before any is reused.  Freed
+         *  indices are recycled in FIFO order, so an index isn't reused
+         *  until this many others were freed after it - stale ids then
+         *  need many more recycles to wrap the iteration counter */
+        uint32_t recycleDelay = 1024;
     };
     
     EntityStore(const InitParams& params, const Allocator& allocator=Allocator());
@@ -75,18 +81,72 @@ public:
     
     Entity create(EntityContextType context=0);
     void destroy(Entity eid);
+    /**
+     * Creates entities in bulk.
+     *
+     * @param  count    Number of entities to create
+     * @param  context  Context assigned to each entity
+     * @param  out      Array receiving count entity ids
+     * @return Number of entities created, less than count only if the
+     *         entity index space is exhausted
+     */
+    uint32_t createBatch(uint32_t count, EntityContextType context, Entity* out);
+    /**
+     * Destroys entities in bulk.  Invalid or already destroyed ids are
+     * skipped.
+     */
+    void destroyBatch(const Entity* eids, uint32_t count);
+    /** Queues an entity for destruction on the next gc() */
+    void destroyDeferred(Entity eid);
+    /**
+     * Creates an entity from any thread.  See reserveBatch.
+     *
+     * @return The entity id, or 0 if no index could be reserved
+     */
+    Entity reserve(EntityContextType context=0);
+    /**
+     * Creates entities from any thread.  Reservations pop recyclable
+     * indices from the free FIFO and then claim fresh indices with atomic
+     * operations, and the ids are valid() immediately.  Fresh indices come
+     * only from the store's current capacity, which is grown by create on
+     * the owning thread.
+     *
+     * Reservations may run concurrently with each other and with valid(),
+     * but not with create, destroy or gc.
+     *
+     * @param  count    Number of entities to create
+     * @param  context  Context assigned to each entity
+     * @param  out      Array receiving the entity ids
+     * @return Number of entities created, less than count if capacity ran
+     *         out
+     */
+    uint32_t reserveBatch(uint32_t count, EntityContextType context, Entity* out);
     
     bool valid(Entity eid) const;
+    /** Destroys entities queued by destroyDeferred */
     void gc();
     
     void diagnostics(EntityDiagnostics& diagnostics);
     
 private:
-    //  objects indexed by the offset value of the EntityId
+    friend class EntitySnapshot;
+
+    uint32_t popFreed(uint32_t count, EntityContextType context, Entity* out);
+    uint32_t claimFresh(uint32_t count, EntityContextType context, Entity* out);
+    void compactFreed();
+
+    //  objects indexed by the offset value of the EntityId.  entries at
+    //  and beyond _indexCount are preset to the first iteration, so that
+    //  indices can be claimed without writing to the vector
     vector<EntityIterationType> _iterations;
+    std::atomic<EntityIndexType> _indexCount;
+    //  FIFO of freed indices, starting at _freedHead
     vector<EntityIndexType> _freed;
+    std::atomic<uint32_t> _freedHead;
+    uint32_t _recycleDelay;
+    vector<Entity> _destroyQueue;
     EntityIterationType _entityIdIteration;
-    EntityIndexType _entityCount;
+    std::atomic<EntityIndexType> _entityCount;
 };
 
 } /* namespace cinek */
@@ -0,0 +1,458 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/transformhierarchy.cpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   SoA transform hierarchy with dirty propagation
+ * @copyright Cinekine
+ */
+
+#include "transformhierarchy.hpp"
+
+#include "cinek/parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinek {
+
+namespace {
+
+    //  out = parent * local for affine matrices, skipping the constant
+    //  bottom row.  out must not alias either input.
+    void composeAffine
+    (
+        ckm::matrix4& out,
+        const ckm::matrix4& parent,
+        const ckm::matrix4& local
+    )
+    {
+        const ckm::scalar* p = parent.comp;
+        const ckm::scalar* l = local.comp;
+        ckm::scalar* o = out.comp;
+        for (int c = 0; c < 4; ++c)
+        {
+            const ckm::scalar* lc = l + c*4;
+            o[c*4+0] = p[0]*lc[0] + p[4]*lc[1] + p[8]*lc[2];
+            o[c*4+1] = p[1]*lc[0] + p[5]*lc[1] + p[9]*lc[2];
+            o[c*4+2] = p[2]*lc[0] + p[6]*lc[1] + p[10]*lc[2];
+            o[c*4+3] = 0;
+        }
+        o[12] += p[12];
+        o[13] += p[13];
+        o[14] += p[14];
+        o[15] = 1;
+    }
+
+    template<typename T>
+    void rotateRange(vector<T>& v, uint32_t first, uint32_t middle, uint32_t last)
+    {
+        std::rotate(v.begin() + first, v.begin() + middle, v.begin() + last);
+    }
+
+    template<typename T>
+    void eraseRange(vector<T>& v, uint32_t first, uint32_t last)
+    {
+        v.erase(v.begin() + first, v.begin() + last);
+    }
+
+}
+
+const uint32_t TransformHierarchy::kNoParent;
+const uint32_t TransformHierarchy::kInvalidSlot;
+
+TransformHierarchy::TransformHierarchy
+(
+    const InitParams& params,
+    const Allocator& allocator
+) :
+    _slots(allocator),
+    _entities(allocator),
+    _parents(allocator),
+    _sizes(allocator),
+    _positions(allocator),
+    _rotations(allocator),
+    _scales(allocator),
+    _worlds(allocator),
+    _dirty(allocator),
+    _roots(allocator),
+    _dirtyCount(0),
+    _rootsValid(true)
+{
+    _slots.reserve(params.entityLimit);
+    _entities.reserve(params.transformLimit);
+    _parents.reserve(params.transformLimit);
+    _sizes.reserve(params.transformLimit);
+    _positions.reserve(params.transformLimit);
+    _rotations.reserve(params.transformLimit);
+    _scales.reserve(params.transformLimit);
+    _worlds.reserve(params.transformLimit);
+    _dirty.reserve(params.transformLimit);
+}
+
+uint32_t TransformHierarchy::slot(Entity eid) const
+{
+    EntityIndexType index = cinek_entity_index(eid);
+    if (!eid || index >= _slots.size())
+        return kInvalidSlot;
+    uint32_t slot = _slots[index];
+    if (slot == kInvalidSlot || _entities[slot] != eid)
+        return kInvalidSlot;
+    return slot;
+}
+
+Entity TransformHierarchy::parent(Entity eid) const
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot || _parents[index] == kNoParent)
+        return 0;
+    return _entities[_parents[index]];
+}
+
+bool TransformHierarchy::add(Entity eid, Entity parent)
+{
+    if (!eid || slot(eid) != kInvalidSlot)
+        return false;
+    uint32_t parentSlot = kNoParent;
+    if (parent)
+    {
+        parentSlot = slot(parent);
+        if (parentSlot == kInvalidSlot)
+            return false;
+    }
+
+    EntityIndexType index = cinek_entity_index(eid);
+    if (index >= _slots.size())
+        _slots.resize(index + 1, kInvalidSlot);
+
+    //  new transforms start as a root at the end of the arrays
+    uint32_t newSlot = size();
+    _slots[index] = newSlot;
+    _entities.push_back(eid);
+    _parents.push_back(kNoParent);
+    _sizes.push_back(1);
+    _positions.push_back(ckm::vector3::kZero);
+    _rotations.push_back(ckm::quat::kIdentity);
+    _scales.push_back(ckm::vector3(1));
+    _worlds.push_back(ckm::matrix4::kIdentity);
+    _dirty.push_back(0);
+    _rootsValid = false;
+
+    if (parentSlot != kNoParent)
+        attach(newSlot, parentSlot);
+    markDirty(slot(eid));
+    return true;
+}
+
+uint32_t TransformHierarchy::remove(Entity eid)
+{
+    uint32_t first = slot(eid);
+    if (first == kInvalidSlot)
+        return 0;
+
+    const uint32_t count = _sizes[first];
+    const uint32_t last = first + count;
+    adjustAncestors(first, -(int32_t)count);
+    for (uint32_t i = first; i < last; ++i)
+    {
+        _slots[cinek_entity_index(_entities[i])] = kInvalidSlot;
+        if (_dirty[i])
+            --_dirtyCount;
+    }
+
+    eraseRange(_entities, first, last);
+    eraseRange(_parents, first, last);
+    eraseRange(_sizes, first, last);
+    eraseRange(_positions, first, last);
+    eraseRange(_rotations, first, last);
+    eraseRange(_scales, first, last);
+    eraseRange(_worlds, first, last);
+    eraseRange(_dirty, first, last);
+
+    //  transforms after the removed subtree shift down - none of them
+    //  can have had a parent inside it
+    for (uint32_t i = first; i < size(); ++i)
+    {
+        if (_parents[i] != kNoParent && _parents[i] >= last)
+            _parents[i] -= count;
+        _slots[cinek_entity_index(_entities[i])] = i;
+    }
+    _rootsValid = false;
+    return count;
+}
+
+bool TransformHierarchy::setParent(Entity eid, Entity parent)
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot)
+        return false;
+    uint32_t parentSlot = kNoParent;
+    if (parent)
+    {
+        parentSlot = slot(parent);
+        if (parentSlot == kInvalidSlot)
+            return false;
+        if (parentSlot >= index && parentSlot < index + _sizes[index])
+            return false;
+    }
+    if (_parents[index] == parentSlot)
+        return true;
+
+    index = detach(index);
+    if (parent)
+        attach(index, slot(parent));
+    markDirty(slot(eid));
+    return true;
+}
+
+void TransformHierarchy::clear()
+{
+    for (Entity eid : _entities)
+        _slots[cinek_entity_index(eid)] = kInvalidSlot;
+    _entities.clear();
+    _parents.clear();
+    _sizes.clear();
+    _positions.clear();
+    _rotations.clear();
+    _scales.clear();
+    _worlds.clear();
+    _dirty.clear();
+    _roots.clear();
+    _dirtyCount = 0;
+    _rootsValid = true;
+}
+
+bool TransformHierarchy::setPosition(Entity eid, const ckm::vector3& position)
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot)
+        return false;
+    _positions[index] = position;
+    markDirty(index);
+    return true;
+}
+
+bool TransformHierarchy::setRotation(Entity eid, const ckm::quat& rotation)
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot)
+        return false;
+    _rotations[index] = rotation;
+    markDirty(index);
+    return true;
+}
+
+bool TransformHierarchy::setScale(Entity eid, const ckm::vector3& scale)
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot)
+        return false;
+    _scales[index] = scale;
+    markDirty(index);
+    return true;
+}
+
+bool TransformHierarchy::setLocal
+(
+    Entity eid,
+    const ckm::vector3& position,
+    const ckm::quat& rotation,
+    const ckm::vector3& scale
+)
+{
+    uint32_t index = slot(eid);
+    if (index == kInvalidSlot)
+        return false;
+    _positions[index] = position;
+    _rotations[index] = rotation;
+    _scales[index] = scale;
+    markDirty(index);
+    return true;
+}
+
+const ckm::vector3* TransformHierarchy::position(Entity eid) const
+{
+    uint32_t index = slot(eid);
+    return index != kInvalidSlot ? &_positions[index] : nullptr;
+}
+
+const ckm::quat* TransformHierarchy::rotation(Entity eid) const
+{
+    uint32_t index = slot(eid);
+    return index != kInvalidSlot ? &_rotations[index] : nullptr;
+}
+
+const ckm::vector3* TransformHierarchy::scale(Entity eid) const
+{
+    uint32_t index = slot(eid);
+    return index != kInvalidSlot ? &_scales[index] : nullptr;
+}
+
+const ckm::matrix4* TransformHierarchy::worldMatrix(Entity eid) const
+{
+    uint32_t index = slot(eid);
+    return index != kInvalidSlot ? &_worlds[index] : nullptr;
+}
+
+void TransformHierarchy::update()
+{
+    if (!_dirtyCount)
+        return;
+    updateRange(0, size());
+    _dirtyCount = 0;
+}
+
+void TransformHierarchy::update(JobSystem& jobSystem, uint32_t grain)
+{
+    if (!_dirtyCount)
+        return;
+    updateRoots();
+
+    const uint32_t rootCount = (uint32_t)_roots.size();
+    parallelFor(jobSystem, 0, rootCount, grain,
+        [this, rootCount](uint32_t first, uint32_t last) {
+            updateRange(_roots[first],
+                        last < rootCount ? _roots[last] : size());
+        });
+    _dirtyCount = 0;
+}
+
+void TransformHierarchy::markDirty(uint32_t slot)
+{
+    if (!_dirty[slot])
+    {
+        _dirty[slot] = 1;
+        ++_dirtyCount;
+    }
+}
+
+void TransformHierarchy::adjustAncestors(uint32_t slot, int32_t delta)
+{
+    for (uint32_t p = _parents[slot]; p != kNoParent; p = _parents[p])
+        _sizes[p] += delta;
+}
+
+void TransformHierarchy::moveRange
+(
+    uint32_t first,
+    uint32_t middle,
+    uint32_t last
+)
+{
+    //  swaps [first, middle) and [middle, last) in every array
+    rotateRange(_entities, first, middle, last);
+    rotateRange(_parents, first, middle, last);
+    rotateRange(_sizes, first, middle, last);
+    rotateRange(_positions, first, middle, last);
+    rotateRange(_rotations, first, middle, last);
+    rotateRange(_scales, first, middle, last);
+    rotateRange(_worlds, first, middle, last);
+    rotateRange(_dirty, first, middle, last);
+
+    const uint32_t lowerShift = last - middle;
+    const uint32_t upperShift = middle - first;
+    for (uint32_t& parent : _parents)
+    {
+        if (parent == kNoParent || parent < first || parent >= last)
+            continue;
+        if (parent < middle)
+            parent += lowerShift;
+        else
+            parent -= upperShift;
+    }
+    for (uint32_t i = first; i < last; ++i)
+        _slots[cinek_entity_index(_entities[i])] = i;
+    _rootsValid = false;
+}
+
+uint32_t TransformHierarchy::detach(uint32_t slot)
+{
+    //  make the subtree a root at the end of the arrays
+    const uint32_t count = _sizes[slot];
+    adjustAncestors(slot, -(int32_t)count);
+    _parents[slot] = kNoParent;
+    if (slot + count < size())
+    {
+        moveRange(slot, slot + count, size());
+        slot = size() - count;
+    }
+    return slot;
+}
+
+void TransformHierarchy::attach(uint32_t slot, uint32_t parentSlot)
+{
+    //  moves a root subtree to the end of the parent's subtree.  As the
+    //  subtree is a root, the parent lies entirely before or after it.
+    const uint32_t count = _sizes[slot];
+    const uint32_t dest = parentSlot + _sizes[parentSlot];
+    _parents[slot] = parentSlot;
+    adjustAncestors(slot, (int32_t)count);
+    if (dest < slot)
+        moveRange(dest, slot, slot + count);
+    else if (dest > slot + count)
+        moveRange(slot, slot + count, dest);
+}
+
+void TransformHierarchy::updateRoots()
+{
+    if (_rootsValid)
+        return;
+    _roots.clear();
+    for (uint32_t i = 0; i < size(); i += _sizes[i])
+        _roots.push_back(i);
+    _rootsValid = true;
+}
+
+void TransformHierarchy::updateRange(uint32_t first, uint32_t last)
+{
+    //  [first, last) holds whole root subtrees, so each parent is handled
+    //  before its children within the same range.  Dirty flags propagate
+    //  down as the pass goes, and are cleared once it's done.
+    ckm::matrix4 local;
+    for (uint32_t i = first; i < last; ++i)
+    {
+        const uint32_t parent = _parents[i];
+        if (parent != kNoParent && _dirty[parent])
+            _dirty[i] = 1;
+        if (!_dirty[i])
+            continue;
+
+        const ckm::vector3& scale = _scales[i];
+        ckm::matrixFromQuatAndTranslate(local, _rotations[i], _positions[i]);
+        for (int c = 0; c < 3; ++c)
+        {
+            local.comp[c*4+0] *= scale.comp[c];
+            local.comp[c*4+1] *= scale.comp[c];
+            local.comp[c*4+2] *= scale.comp[c];
+        }
+        if (parent == kNoParent)
+            _worlds[i] = local;
+        else
+            composeAffine(_worlds[i], _worlds[parent], local);
+    }
+    if (last > first)
+        memset(_dirty.data() + first, 0, last - first);
+}
+
+} /* namespace cinek */
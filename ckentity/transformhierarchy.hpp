@@ -0,0 +1,201 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Cinekine Media
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file    ckentity/transformhierarchy.hpp
+ * @author  Samir Sinha
+ * @date    10/18/2026
+ * @brief   SoA transform hierarchy with dirty propagation
+ * @copyright Cinekine
+ */
+
+#ifndef CINEK_TRANSFORM_HIERARCHY_HPP
+#define CINEK_TRANSFORM_HIERARCHY_HPP
+
+#include "entity.h"
+
+#include "cinek/vector.hpp"
+#include "cinek/allocator.hpp"
+#include "ckm/math.hpp"
+
+namespace cinek {
+
+class JobSystem;
+
+/**
+ *  @class  TransformHierarchy
+ *  @brief  Parent-relative entity transforms stored as SoA arrays
+ *
+ *  Each entity has a local position, rotation and scale relative to its
+ *  parent, and a world matrix computed from its parent's.  Transforms are
+ *  kept in topological order - every subtree occupies a contiguous range
+ *  of slots headed by its root - so a single forward pass over the arrays
+ *  visits parents before their children.
+ *
+ *  Changing a local transform flags its entity as dirty.  update()
+ *  recomputes world matrices of dirty entities and their descendants only,
+ *  leaving clean subtrees untouched.  As subtrees are contiguous, update()
+ *  can split the pass across a JobSystem's workers at root boundaries.
+ *
+ *  Adding, removing or reparenting an entity moves array ranges to keep
+ *  subtrees contiguous, and is linear in the number of transforms.  These
+ *  structural changes are meant to be rare compared to local transform
+ *  changes.
+ *
+ *  Matrices follow the ckm convention (i.e. matrixFromQuatAndTranslate),
+ *  with the translation held in comp[12..14].
+ */
+class TransformHierarchy
+{
+    CK_CLASS_NON_COPYABLE(TransformHierarchy);
+
+public:
+    /** Parent slot of root transforms */
+    static const uint32_t kNoParent = 0xffffffff;
+    /** Slot returned for entities without a transform */
+    static const uint32_t kInvalidSlot = 0xffffffff;
+
+    struct InitParams
+    {
+        /** Number of entity indices to reserve */
+        uint32_t entityLimit;
+        /** Number of transforms to reserve */
+        uint32_t transformLimit;
+    };
+
+    TransformHierarchy(const InitParams& params,
+                       const Allocator& allocator=Allocator());
+
+    /**
+     * Adds an entity with an identity local transform as the last child of
+     * a parent.
+     *
+     * @param  eid      The entity
+     * @param  parent   The parent entity, or zero to add a root
+     * @return False if the entity already has a transform or the parent
+     *         has none
+     */
+    bool add(Entity eid, Entity parent=0);
+    /**
+     * Removes an entity's transform and those of all its descendants.
+     *
+     * @param  eid  The entity
+     * @return Number of transforms removed
+     */
+    uint32_t remove(Entity eid);
+    /**
+     * Moves an entity and its descendants under a new parent, keeping
+     * their local transforms.
+     *
+     * @param  eid      The entity
+     * @param  parent   The new parent, or zero to make the entity a root
+     * @return False if either entity has no transform, or if the parent
+     *         is a descendant of the entity
+     */
+    bool setParent(Entity eid, Entity parent);
+    /** Removes all transforms, retaining memory */
+    void clear();
+
+    /** @return True if the entity has a transform */
+    bool has(Entity eid) const { return slot(eid) != kInvalidSlot; }
+    /** @return The entity's slot in the SoA arrays, or kInvalidSlot.  Slots
+     *          change whenever transforms are added, removed or
+     *          reparented */
+    uint32_t slot(Entity eid) const;
+    /** @return The parent entity, or zero for roots and unknown entities */
+    Entity parent(Entity eid) const;
+
+    bool setPosition(Entity eid, const ckm::vector3& position);
+    bool setRotation(Entity eid, const ckm::quat& rotation);
+    bool setScale(Entity eid, const ckm::vector3& scale);
+    bool setLocal(Entity eid, const ckm::vector3& position,
+                  const ckm::quat& rotation, const ckm::vector3& scale);
+
+    /** @return The local position, or nullptr if the entity has none */
+    const ckm::vector3* position(Entity eid) const;
+    /** @return The local rotation, or nullptr if the entity has none */
+    const ckm::quat* rotation(Entity eid) const;
+    /** @return The local scale, or nullptr if the entity has none */
+    const ckm::vector3* scale(Entity eid) const;
+    /** @return The world matrix as of the last update, or nullptr if the
+     *          entity has no transform */
+    const ckm::matrix4* worldMatrix(Entity eid) const;
+
+    /** Recomputes world matrices of dirty subtrees on the calling thread */
+    void update();
+    /**
+     * Recomputes world matrices of dirty subtrees across a JobSystem's
+     * workers.  Work is divided between root subtrees, so a hierarchy with
+     * a single large root runs serially.
+     *
+     * @param jobSystem The JobSystem executing the update
+     * @param grain     Root subtrees per job, or zero to choose
+     *                  automatically
+     */
+    void update(JobSystem& jobSystem, uint32_t grain=0);
+
+    /** @return Number of transforms */
+    uint32_t size() const { return (uint32_t)_entities.size(); }
+    bool empty() const { return _entities.empty(); }
+    /** @return Number of transforms changed since the last update */
+    uint32_t dirtyCount() const { return _dirtyCount; }
+
+    /** @return Entities in topological order */
+    const Entity* entities() const { return _entities.data(); }
+    /** @return Parent slots, parallel to entities(), or kNoParent */
+    const uint32_t* parents() const { return _parents.data(); }
+    /** @return Number of transforms in each slot's subtree, including
+     *          itself */
+    const uint32_t* subtreeSizes() const { return _sizes.data(); }
+    const ckm::vector3* positions() const { return _positions.data(); }
+    const ckm::quat* rotations() const { return _rotations.data(); }
+    const ckm::vector3* scales() const { return _scales.data(); }
+    const ckm::matrix4* worldMatrices() const { return _worlds.data(); }
+
+private:
+    void markDirty(uint32_t slot);
+    void adjustAncestors(uint32_t slot, int32_t delta);
+    void moveRange(uint32_t first, uint32_t middle, uint32_t last);
+    uint32_t detach(uint32_t slot);
+    void attach(uint32_t slot, uint32_t parentSlot);
+    void updateRoots();
+    void updateRange(uint32_t first, uint32_t last);
+
+    vector<uint32_t> _slots;
+    vector<Entity> _entities;
+    vector<uint32_t> _parents;
+    vector<uint32_t> _sizes;
+    vector<ckm::vector3> _positions;
+    vector<ckm::quat> _rotations;
+    vector<ckm::vector3> _scales;
+    vector<ckm::matrix4> _worlds;
+    vector<uint8_t> _dirty;
+    //  first slot of each root subtree, rebuilt by update after structural
+    //  changes
+    vector<uint32_t> _roots;
+    uint32_t _dirtyCount;
+    bool _rootsValid;
+};
+
+} /* namespace cinek */
+
+#endif
@@ -0,0 +1,155 @@
+//
+//  aabbtree.hpp
+//  ckm
+//
+//  Created by Samir Sinha on 10/18/26.
+//  Copyright (c) 2026 Cinekine. All rights reserved.
+//
+
+#ifndef CINEK_MATH_AABB_TREE_HPP
+#define CINEK_MATH_AABB_TREE_HPP
+
+#include "geometry.hpp"
+#include "aabb.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ckm {
+
+    /// @class  aabbtree
+    /// @brief  A dynamic bounding volume hierarchy for broadphase queries
+    /// @detail Each proxy is a leaf holding a "fat" AABB - the proxy's box
+    ///         expanded by a margin - so that small movements don't touch
+    ///         the tree.  A proxy escaping its fat box is reinserted, and
+    ///         the path back to the root is rebalanced with tree rotations,
+    ///         keeping the height logarithmic in the proxy count.
+    ///
+    ///         Nodes live in a contiguous pool, and proxy ids are node
+    ///         indices that stay valid until the proxy is removed.  Queries
+    ///         are const and may run concurrently with each other.
+    ///
+    template<typename _Point, typename _Data=void*>
+    class aabbtree
+    {
+    public:
+        typedef _Point                          point_type;
+        typedef AABB<_Point>                    aabb_type;
+        typedef typename _Point::value_type     value_type;
+        typedef _Data                           data_type;
+
+        static constexpr int32_t kNull = -1;
+
+        /// Constructor
+        /// @param margin   Distance each proxy box is expanded by
+        /// @param capacity Number of nodes to reserve
+        ///
+        aabbtree(value_type margin=value_type(0.1), int32_t capacity=16);
+
+        /// Adds a proxy
+        /// @param  box     The proxy's bounds
+        /// @param  data    Data returned by data() for the proxy
+        /// @return The proxy id
+        ///
+        int32_t insert(const aabb_type& box, const data_type& data);
+        /// Removes a proxy
+        /// @param  proxy   The proxy id returned by insert
+        ///
+        void remove(int32_t proxy);
+        /// Moves a proxy.  The tree is only modified if the box leaves the
+        /// proxy's fat box.
+        /// @param  proxy   The proxy id
+        /// @param  box     The proxy's new bounds
+        /// @return True if the proxy was reinserted
+        ///
+        bool update(int32_t proxy, const aabb_type& box);
+        /// Removes all proxies, retaining memory
+        ///
+        void clear();
+
+        /// @return The proxy's fat box
+        ///
+        const aabb_type& fatAABB(int32_t proxy) const { return _nodes[proxy].box; }
+        /// @return The data given when inserting the proxy
+        ///
+        const data_type& data(int32_t proxy) const { return _nodes[proxy].data; }
+        /// @return Number of proxies in the tree
+        ///
+        int32_t proxyCount() const { return _proxyCount; }
+        /// @return Height of the tree, where a single leaf has height zero
+        ///
+        int32_t height() const { return _root != kNull ? _nodes[_root].height : 0; }
+
+        /// Invokes fn(proxy) for each proxy whose fat box intersects a box
+        ///
+        template<typename Fn> void query(const aabb_type& box, Fn&& fn) const;
+        /// Invokes fn(proxy) for each proxy whose fat box intersects a
+        /// sphere
+        ///
+        template<typename Fn> void querySphere(const point_type& center,
+                                               value_type radius,
+                                               Fn&& fn) const;
+        /// Invokes fn(proxy) for each proxy whose fat box is at least
+        /// partially inside a frustrum
+        ///
+        template<typename Fn> void queryFrustrum(const frustrum<point_type>& volume,
+                                                 Fn&& fn) const;
+        /// Invokes fn(proxyA, proxyB) once for each pair of proxies with
+        /// intersecting fat boxes, where proxyA < proxyB.
+        ///
+        template<typename Fn> void findPairs(Fn&& fn) const;
+        /// Invokes fn(proxyA, proxyB) once for each pair of intersecting
+        /// fat boxes where at least one proxy was inserted or reinserted
+        /// since the last call, with proxyA < proxyB.  Pairs of proxies
+        /// that stayed within their fat boxes aren't revisited, so the cost
+        /// follows the number of moving proxies rather than the total.
+        ///
+        template<typename Fn> void updatePairs(Fn&& fn);
+
+    private:
+        /// Upper bound on the depth of a balanced tree with int32_t ids
+        ///
+        static constexpr int kStackLimit = 128;
+
+        struct node
+        {
+            aabb_type box;
+            data_type data;
+            int32_t parent;     ///< Or the next free node when in the pool
+            int32_t child1;
+            int32_t child2;
+            int32_t height;     ///< Zero for leaves, -1 for free nodes
+            bool moved;
+
+            bool isLeaf() const { return child1 == kNull; }
+        };
+
+        int32_t allocateNode();
+        void freeNode(int32_t id);
+        void insertLeaf(int32_t leaf);
+        void removeLeaf(int32_t leaf);
+        int32_t balance(int32_t id);
+        void refit(int32_t id);
+        void fatten(aabb_type& fat, const aabb_type& box) const;
+        void bufferMove(int32_t proxy);
+        void unbufferMove(int32_t proxy);
+        template<typename Test, typename Fn> void traverse(const Test& test,
+                                                           Fn& fn) const;
+
+        static aabb_type combine(const aabb_type& a, const aabb_type& b);
+        static value_type area(const aabb_type& box);
+
+        std::vector<node> _nodes;
+        std::vector<int32_t> _moveBuffer;
+        int32_t _root;
+        int32_t _freeList;
+        int32_t _proxyCount;
+        value_type _margin;
+    };
+
+}
+
+#include "aabbtree.inl"
+
+#endif
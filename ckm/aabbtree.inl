@@ -0,0 +1,517 @@
+//
+//  aabbtree.inl
+//  ckm
+//
+//  Created by Samir Sinha on 10/18/26.
+//  Copyright (c) 2026 Cinekine. All rights reserved.
+//
+
+namespace ckm {
+
+    template<typename _Point, typename _Data>
+    aabbtree<_Point, _Data>::aabbtree
+    (
+        value_type margin,
+        int32_t capacity
+    ) :
+        _nodes(),
+        _moveBuffer(),
+        _root(kNull),
+        _freeList(kNull),
+        _proxyCount(0),
+        _margin(margin)
+    {
+        _nodes.reserve(capacity);
+    }
+
+    template<typename _Point, typename _Data>
+    int32_t aabbtree<_Point, _Data>::insert
+    (
+        const aabb_type& box,
+        const data_type& data
+    )
+    {
+        int32_t proxy = allocateNode();
+        node& leaf = _nodes[proxy];
+        fatten(leaf.box, box);
+        leaf.data = data;
+        leaf.height = 0;
+        insertLeaf(proxy);
+        bufferMove(proxy);
+        ++_proxyCount;
+        return proxy;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::remove(int32_t proxy)
+    {
+        if (_nodes[proxy].moved)
+            unbufferMove(proxy);
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --_proxyCount;
+    }
+
+    template<typename _Point, typename _Data>
+    bool aabbtree<_Point, _Data>::update
+    (
+        int32_t proxy,
+        const aabb_type& box
+    )
+    {
+        if (box.inside(_nodes[proxy].box))
+            return false;
+
+        removeLeaf(proxy);
+        fatten(_nodes[proxy].box, box);
+        insertLeaf(proxy);
+        bufferMove(proxy);
+        return true;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::clear()
+    {
+        _nodes.clear();
+        _moveBuffer.clear();
+        _root = kNull;
+        _freeList = kNull;
+        _proxyCount = 0;
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void aabbtree<_Point, _Data>::query
+    (
+        const aabb_type& box,
+        Fn&& fn
+    )
+    const
+    {
+        traverse([&box](const aabb_type& nodeBox) {
+            return nodeBox.intersects(box);
+        }, fn);
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void aabbtree<_Point, _Data>::querySphere
+    (
+        const point_type& center,
+        value_type radius,
+        Fn&& fn
+    )
+    const
+    {
+        traverse([&center, radius](const aabb_type& nodeBox) {
+            return nodeBox.intersectsWithSphere(center, radius);
+        }, fn);
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void aabbtree<_Point, _Data>::queryFrustrum
+    (
+        const frustrum<point_type>& volume,
+        Fn&& fn
+    )
+    const
+    {
+        traverse([&volume](const aabb_type& nodeBox) {
+            return volume.testAABB(nodeBox);
+        }, fn);
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void aabbtree<_Point, _Data>::findPairs(Fn&& fn) const
+    {
+        for (int32_t id = 0; id < (int32_t)_nodes.size(); ++id)
+        {
+            const node& leaf = _nodes[id];
+            if (leaf.height != 0)
+                continue;
+            query(leaf.box, [&fn, id](int32_t other) {
+                if (other > id)
+                    fn(id, other);
+            });
+        }
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void aabbtree<_Point, _Data>::updatePairs(Fn&& fn)
+    {
+        for (int32_t proxy : _moveBuffer)
+        {
+            if (proxy == kNull)
+                continue;
+            query(_nodes[proxy].box, [this, &fn, proxy](int32_t other) {
+                if (other == proxy)
+                    return;
+                //  when both proxies moved, the pair is reported while
+                //  visiting the larger id
+                if (_nodes[other].moved && other > proxy)
+                    return;
+                if (other < proxy)
+                    fn(other, proxy);
+                else
+                    fn(proxy, other);
+            });
+        }
+        for (int32_t proxy : _moveBuffer)
+        {
+            if (proxy != kNull)
+                _nodes[proxy].moved = false;
+        }
+        _moveBuffer.clear();
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Test, typename Fn>
+    void aabbtree<_Point, _Data>::traverse
+    (
+        const Test& test,
+        Fn& fn
+    )
+    const
+    {
+        if (_root == kNull)
+            return;
+
+        int32_t stack[kStackLimit];
+        int count = 0;
+        stack[count++] = _root;
+        while (count)
+        {
+            const node& n = _nodes[stack[--count]];
+            if (!test(n.box))
+                continue;
+            if (n.isLeaf())
+            {
+                fn((int32_t)(&n - _nodes.data()));
+            }
+            else
+            {
+                stack[count++] = n.child1;
+                stack[count++] = n.child2;
+            }
+        }
+    }
+
+    template<typename _Point, typename _Data>
+    int32_t aabbtree<_Point, _Data>::allocateNode()
+    {
+        if (_freeList == kNull)
+        {
+            //  grow the pool, threading the new nodes onto the free list
+            int32_t first = (int32_t)_nodes.size();
+            int32_t count = first ? first : 16;
+            _nodes.resize(first + count);
+            for (int32_t i = first; i < first + count; ++i)
+            {
+                _nodes[i].parent = i + 1;
+                _nodes[i].height = -1;
+            }
+            _nodes[first + count - 1].parent = kNull;
+            _freeList = first;
+        }
+        int32_t id = _freeList;
+        node& n = _nodes[id];
+        _freeList = n.parent;
+        n.parent = kNull;
+        n.child1 = kNull;
+        n.child2 = kNull;
+        n.height = 0;
+        n.moved = false;
+        return id;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::freeNode(int32_t id)
+    {
+        node& n = _nodes[id];
+        n.parent = _freeList;
+        n.height = -1;
+        _freeList = id;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::insertLeaf(int32_t leaf)
+    {
+        if (_root == kNull)
+        {
+            _root = leaf;
+            _nodes[leaf].parent = kNull;
+            return;
+        }
+
+        //  descend to the sibling with the least surface area cost,
+        //  stopping early when pairing with the current node is cheapest
+        const aabb_type leafBox = _nodes[leaf].box;
+        int32_t index = _root;
+        while (!_nodes[index].isLeaf())
+        {
+            const node& n = _nodes[index];
+            const value_type nodeArea = area(n.box);
+            const value_type combinedArea = area(combine(n.box, leafBox));
+            const value_type cost = 2 * combinedArea;
+            const value_type inheritanceCost = 2 * (combinedArea - nodeArea);
+
+            auto childCost = [&](int32_t child) -> value_type {
+                const node& c = _nodes[child];
+                value_type childArea = area(combine(c.box, leafBox));
+                if (!c.isLeaf())
+                    childArea -= area(c.box);
+                return childArea + inheritanceCost;
+            };
+            const value_type cost1 = childCost(n.child1);
+            const value_type cost2 = childCost(n.child2);
+            if (cost < cost1 && cost < cost2)
+                break;
+            index = cost1 < cost2 ? n.child1 : n.child2;
+        }
+
+        const int32_t sibling = index;
+        const int32_t oldParent = _nodes[sibling].parent;
+        const int32_t newParent = allocateNode();
+        node& parent = _nodes[newParent];
+        parent.parent = oldParent;
+        parent.box = combine(leafBox, _nodes[sibling].box);
+        parent.height = _nodes[sibling].height + 1;
+        parent.child1 = sibling;
+        parent.child2 = leaf;
+        if (oldParent != kNull)
+        {
+            node& old = _nodes[oldParent];
+            if (old.child1 == sibling)
+                old.child1 = newParent;
+            else
+                old.child2 = newParent;
+        }
+        else
+        {
+            _root = newParent;
+        }
+        _nodes[sibling].parent = newParent;
+        _nodes[leaf].parent = newParent;
+
+        refit(newParent);
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::removeLeaf(int32_t leaf)
+    {
+        if (leaf == _root)
+        {
+            _root = kNull;
+            return;
+        }
+
+        const int32_t parent = _nodes[leaf].parent;
+        const int32_t grandParent = _nodes[parent].parent;
+        const int32_t sibling = _nodes[parent].child1 == leaf ?
+            _nodes[parent].child2 : _nodes[parent].child1;
+
+        //  the sibling takes the parent's place
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        if (grandParent != kNull)
+        {
+            node& g = _nodes[grandParent];
+            if (g.child1 == parent)
+                g.child1 = sibling;
+            else
+                g.child2 = sibling;
+            refit(grandParent);
+        }
+        else
+        {
+            _root = sibling;
+        }
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::refit(int32_t id)
+    {
+        //  rebalance and recompute bounds from a node up to the root
+        while (id != kNull)
+        {
+            id = balance(id);
+            node& n = _nodes[id];
+            const node& c1 = _nodes[n.child1];
+            const node& c2 = _nodes[n.child2];
+            n.height = 1 + std::max(c1.height, c2.height);
+            n.box = combine(c1.box, c2.box);
+            id = n.parent;
+        }
+    }
+
+    template<typename _Point, typename _Data>
+    int32_t aabbtree<_Point, _Data>::balance(int32_t iA)
+    {
+        //  rotates a child up if the node's subtrees differ in height by
+        //  more than one, returning the node now in A's place
+        node& A = _nodes[iA];
+        if (A.isLeaf() || A.height < 2)
+            return iA;
+
+        const int32_t iB = A.child1;
+        const int32_t iC = A.child2;
+        node& B = _nodes[iB];
+        node& C = _nodes[iC];
+        const int32_t diff = C.height - B.height;
+
+        if (diff > 1)
+        {
+            //  rotate C up
+            const int32_t iF = C.child1;
+            const int32_t iG = C.child2;
+            node& F = _nodes[iF];
+            node& G = _nodes[iG];
+
+            C.child1 = iA;
+            C.parent = A.parent;
+            A.parent = iC;
+            if (C.parent != kNull)
+            {
+                node& p = _nodes[C.parent];
+                if (p.child1 == iA)
+                    p.child1 = iC;
+                else
+                    p.child2 = iC;
+            }
+            else
+            {
+                _root = iC;
+            }
+
+            if (F.height > G.height)
+            {
+                C.child2 = iF;
+                A.child2 = iG;
+                G.parent = iA;
+                A.box = combine(B.box, G.box);
+                C.box = combine(A.box, F.box);
+                A.height = 1 + std::max(B.height, G.height);
+                C.height = 1 + std::max(A.height, F.height);
+            }
+            else
+            {
+                C.child2 = iG;
+                A.child2 = iF;
+                F.parent = iA;
+                A.box = combine(B.box, F.box);
+                C.box = combine(A.box, G.box);
+                A.height = 1 + std::max(B.height, F.height);
+                C.height = 1 + std::max(A.height, G.height);
+            }
+            return iC;
+        }
+
+        if (diff < -1)
+        {
+            //  rotate B up
+            const int32_t iD = B.child1;
+            const int32_t iE = B.child2;
+            node& D = _nodes[iD];
+            node& E = _nodes[iE];
+
+            B.child1 = iA;
+            B.parent = A.parent;
+            A.parent = iB;
+            if (B.parent != kNull)
+            {
+                node& p = _nodes[B.parent];
+                if (p.child1 == iA)
+                    p.child1 = iB;
+                else
+                    p.child2 = iB;
+            }
+            else
+            {
+                _root = iB;
+            }
+
+            if (D.height > E.height)
+            {
+                B.child2 = iD;
+                A.child1 = iE;
+                E.parent = iA;
+                A.box = combine(C.box, E.box);
+                B.box = combine(A.box, D.box);
+                A.height = 1 + std::max(C.height, E.height);
+                B.height = 1 + std::max(A.height, D.height);
+            }
+            else
+            {
+                B.child2 = iE;
+                A.child1 = iD;
+                D.parent = iA;
+                A.box = combine(C.box, D.box);
+                B.box = combine(A.box, E.box);
+                A.height = 1 + std::max(C.height, D.height);
+                B.height = 1 + std::max(A.height, E.height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::fatten
+    (
+        aabb_type& fat,
+        const aabb_type& box
+    )
+    const
+    {
+        fat.min.x = box.min.x - _margin;
+        fat.min.y = box.min.y - _margin;
+        fat.min.z = box.min.z - _margin;
+        fat.max.x = box.max.x + _margin;
+        fat.max.y = box.max.y + _margin;
+        fat.max.z = box.max.z + _margin;
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::bufferMove(int32_t proxy)
+    {
+        node& leaf = _nodes[proxy];
+        if (leaf.moved)
+            return;
+        leaf.moved = true;
+        _moveBuffer.push_back(proxy);
+    }
+
+    template<typename _Point, typename _Data>
+    void aabbtree<_Point, _Data>::unbufferMove(int32_t proxy)
+    {
+        _nodes[proxy].moved = false;
+        std::replace(_moveBuffer.begin(), _moveBuffer.end(), proxy, kNull);
+    }
+
+    template<typename _Point, typename _Data>
+    auto aabbtree<_Point, _Data>::combine
+    (
+        const aabb_type& a,
+        const aabb_type& b
+    )
+    -> aabb_type
+    {
+        aabb_type result = a;
+        result.merge(b);
+        return result;
+    }
+
+    template<typename _Point, typename _Data>
+    auto aabbtree<_Point, _Data>::area(const aabb_type& box) -> value_type
+    {
+        const value_type dx = box.max.x - box.min.x;
+        const value_type dy = box.max.y - box.min.y;
+        const value_type dz = box.max.z - box.min.z;
+        return 2 * (dx*dy + dy*dz + dz*dx);
+    }
+
+}
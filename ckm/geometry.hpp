@@ -11,6 +11,7 @@
 
 #include "math.hpp"
 
+#include <algorithm>
 #include <array>
 
 namespace ckm {
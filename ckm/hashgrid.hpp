@@ -0,0 +1,133 @@
+//
+//  hashgrid.hpp
+//  ckm
+//
+//  Created by Samir Sinha on 10/18/26.
+//  Copyright (c) 2026 Cinekine. All rights reserved.
+//
+
+#ifndef CINEK_MATH_HASH_GRID_HPP
+#define CINEK_MATH_HASH_GRID_HPP
+
+#include "mathtypes.hpp"
+#include "aabb.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ckm {
+
+    /// @class  hashgrid
+    /// @brief  A uniform grid of points hashed into a fixed bucket table
+    /// @detail Suited to many similarly sized objects spread evenly over a
+    ///         large or unbounded space (i.e. crowds), where radius queries
+    ///         only need to visit a few neighboring cells.
+    ///
+    ///         Inserting, moving and removing points only records them, in
+    ///         constant time.  rebuild() then sorts all points by bucket
+    ///         with a counting sort into one contiguous array, which
+    ///         queries walk until the next rebuild - so a typical frame
+    ///         updates every point, rebuilds once, then runs its queries.
+    ///         Queries are const and may run concurrently with each other.
+    ///
+    template<typename _Point, typename _Data=uint32_t>
+    class hashgrid
+    {
+    public:
+        typedef _Point                          point_type;
+        typedef AABB<_Point>                    aabb_type;
+        typedef typename _Point::value_type     value_type;
+        typedef _Data                           data_type;
+
+        /// Constructor
+        /// @param cellSize     Width of a cell, ideally near the usual query
+        ///                     radius
+        /// @param bucketCount  Size of the cell hash table, rounded up to a
+        ///                     power of two
+        /// @param capacity     Number of points to reserve
+        ///
+        hashgrid(value_type cellSize, uint32_t bucketCount=4096,
+                 uint32_t capacity=0);
+
+        /// Adds a point
+        /// @param  pt      The point's position
+        /// @param  data    Data returned by data() for the point
+        /// @return The point id, valid until the point is removed.  Ids of
+        ///         removed points are reused after the next rebuild()
+        ///
+        uint32_t insert(const point_type& pt, const data_type& data);
+        /// Moves a point.  Queries see the new position after rebuild()
+        /// @param  id  The point id
+        /// @param  pt  The new position
+        ///
+        void update(uint32_t id, const point_type& pt) { _positions[id] = pt; }
+        /// Removes a point.  Queries may return it until rebuild().
+        /// Removing a point that was already removed does nothing.
+        /// @param  id  The point id
+        ///
+        void remove(uint32_t id);
+        /// Removes all points, retaining memory
+        ///
+        void clear();
+        /// Sorts points by cell for queries
+        ///
+        void rebuild();
+
+        /// Invokes fn(id) for each point within a radius of a center, as of
+        /// the last rebuild
+        ///
+        template<typename Fn> void queryRadius(const point_type& center,
+                                               value_type radius,
+                                               Fn&& fn) const;
+
+        /// @return The point's most recent position
+        ///
+        const point_type& position(uint32_t id) const { return _positions[id]; }
+        /// @return The data given when inserting the point
+        ///
+        const data_type& data(uint32_t id) const { return _data[id]; }
+        /// @return Number of points
+        ///
+        uint32_t size() const
+        {
+            return (uint32_t)(_positions.size() - _freeIds.size() - _removedIds.size());
+        }
+        value_type cellSize() const { return _cellSize; }
+
+    private:
+        struct entry
+        {
+            point_type position;
+            int32_t cell[3];
+            uint32_t id;
+        };
+
+        int32_t cellCoord(value_type v) const;
+        uint32_t bucket(int32_t x, int32_t y, int32_t z) const;
+
+        value_type _cellSize;
+        value_type _invCellSize;
+        uint32_t _bucketMask;
+
+        std::vector<point_type> _positions;
+        std::vector<data_type> _data;
+        std::vector<uint8_t> _alive;
+        std::vector<uint32_t> _freeIds;
+        //  ids removed since the last rebuild, which queries may still
+        //  return and so can't be reused yet
+        std::vector<uint32_t> _removedIds;
+
+        //  points sorted by bucket as of the last rebuild, where bucket b
+        //  spans [_bucketStart[b], _bucketStart[b+1])
+        std::vector<entry> _entries;
+        std::vector<uint32_t> _bucketStart;
+        std::vector<uint32_t> _pointBuckets;
+    };
+
+}
+
+#include "hashgrid.inl"
+
+#endif
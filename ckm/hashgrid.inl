@@ -0,0 +1,205 @@
+//
+//  hashgrid.inl
+//  ckm
+//
+//  Created by Samir Sinha on 10/18/26.
+//  Copyright (c) 2026 Cinekine. All rights reserved.
+//
+
+namespace ckm {
+
+    template<typename _Point, typename _Data>
+    hashgrid<_Point, _Data>::hashgrid
+    (
+        value_type cellSize,
+        uint32_t bucketCount,
+        uint32_t capacity
+    ) :
+        _cellSize(cellSize),
+        _invCellSize(value_type(1)/cellSize),
+        _bucketMask(0)
+    {
+        uint32_t count = 1;
+        while (count < bucketCount)
+            count <<= 1;
+        _bucketMask = count - 1;
+        _bucketStart.assign(count + 1, 0);
+
+        _positions.reserve(capacity);
+        _data.reserve(capacity);
+        _alive.reserve(capacity);
+        _entries.reserve(capacity);
+    }
+
+    template<typename _Point, typename _Data>
+    uint32_t hashgrid<_Point, _Data>::insert
+    (
+        const point_type& pt,
+        const data_type& data
+    )
+    {
+        if (!_freeIds.empty())
+        {
+            uint32_t id = _freeIds.back();
+            _freeIds.pop_back();
+            _positions[id] = pt;
+            _data[id] = data;
+            _alive[id] = 1;
+            return id;
+        }
+        _positions.push_back(pt);
+        _data.push_back(data);
+        _alive.push_back(1);
+        return (uint32_t)(_positions.size() - 1);
+    }
+
+    template<typename _Point, typename _Data>
+    void hashgrid<_Point, _Data>::remove(uint32_t id)
+    {
+        if (!_alive[id])
+            return;
+        _alive[id] = 0;
+        _removedIds.push_back(id);
+    }
+
+    template<typename _Point, typename _Data>
+    void hashgrid<_Point, _Data>::clear()
+    {
+        _positions.clear();
+        _data.clear();
+        _alive.clear();
+        _freeIds.clear();
+        _removedIds.clear();
+        _entries.clear();
+        _pointBuckets.clear();
+        std::fill(_bucketStart.begin(), _bucketStart.end(), 0);
+    }
+
+    template<typename _Point, typename _Data>
+    void hashgrid<_Point, _Data>::rebuild()
+    {
+        //  counting sort - count points per bucket, turn the counts into
+        //  start offsets, then scatter points to their bucket's range
+        const uint32_t pointCount = (uint32_t)_positions.size();
+        std::fill(_bucketStart.begin(), _bucketStart.end(), 0);
+        _entries.resize(size());
+
+        //  ids removed since the last rebuild are no longer in the sorted
+        //  entries, so they may now be reused
+        _freeIds.insert(_freeIds.end(), _removedIds.begin(), _removedIds.end());
+        _removedIds.clear();
+
+        _pointBuckets.resize(pointCount);
+        for (uint32_t id = 0; id < pointCount; ++id)
+        {
+            if (!_alive[id])
+                continue;
+            const point_type& pt = _positions[id];
+            _pointBuckets[id] = bucket(cellCoord(pt.x), cellCoord(pt.y), cellCoord(pt.z));
+            ++_bucketStart[_pointBuckets[id] + 1];
+        }
+        for (uint32_t b = 1; b < _bucketStart.size(); ++b)
+            _bucketStart[b] += _bucketStart[b - 1];
+
+        //  scatter through a moving cursor per bucket, borrowing the start
+        //  offsets shifted down by one bucket
+        for (uint32_t id = 0; id < pointCount; ++id)
+        {
+            if (!_alive[id])
+                continue;
+            const point_type& pt = _positions[id];
+            entry& e = _entries[_bucketStart[_pointBuckets[id]]++];
+            e.position = pt;
+            e.cell[0] = cellCoord(pt.x);
+            e.cell[1] = cellCoord(pt.y);
+            e.cell[2] = cellCoord(pt.z);
+            e.id = id;
+        }
+        for (uint32_t b = (uint32_t)_bucketStart.size() - 1; b > 0; --b)
+            _bucketStart[b] = _bucketStart[b - 1];
+        _bucketStart[0] = 0;
+    }
+
+    template<typename _Point, typename _Data>
+    template<typename Fn>
+    void hashgrid<_Point, _Data>::queryRadius
+    (
+        const point_type& center,
+        value_type radius,
+        Fn&& fn
+    )
+    const
+    {
+        //  squared distance along an axis from the center to a cell, zero
+        //  when the center lies within the cell's span
+        auto axisDist2 = [this](value_type c, int32_t cell) {
+            const value_type lo = cell * _cellSize;
+            const value_type hi = lo + _cellSize;
+            const value_type d = c < lo ? lo - c : (c > hi ? c - hi : value_type(0));
+            return d * d;
+        };
+
+        const value_type radius2 = radius * radius;
+        const int32_t x0 = cellCoord(center.x - radius);
+        const int32_t x1 = cellCoord(center.x + radius);
+        const int32_t y0 = cellCoord(center.y - radius);
+        const int32_t y1 = cellCoord(center.y + radius);
+        const int32_t z0 = cellCoord(center.z - radius);
+        const int32_t z1 = cellCoord(center.z + radius);
+
+        for (int32_t z = z0; z <= z1; ++z)
+        {
+            const value_type dz2 = axisDist2(center.z, z);
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                const value_type dyz2 = dz2 + axisDist2(center.y, y);
+                for (int32_t x = x0; x <= x1; ++x)
+                {
+                    //  corner cells of the range often miss the sphere.
+                    //  The test is inclusive, like the point test below,
+                    //  so points exactly at the radius are still found.
+                    if (dyz2 + axisDist2(center.x, x) > radius2)
+                        continue;
+
+                    //  buckets are shared by cells with colliding hashes,
+                    //  so skip points belonging to other cells
+                    const uint32_t b = bucket(x, y, z);
+                    const entry* it = _entries.data() + _bucketStart[b];
+                    const entry* end = _entries.data() + _bucketStart[b + 1];
+                    for (; it != end; ++it)
+                    {
+                        if (it->cell[0] != x || it->cell[1] != y || it->cell[2] != z)
+                            continue;
+                        const value_type dx = it->position.x - center.x;
+                        const value_type dy = it->position.y - center.y;
+                        const value_type dz = it->position.z - center.z;
+                        if (dx*dx + dy*dy + dz*dz <= radius2)
+                            fn(it->id);
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename _Point, typename _Data>
+    int32_t hashgrid<_Point, _Data>::cellCoord(value_type v) const
+    {
+        return (int32_t)std::floor(v * _invCellSize);
+    }
+
+    template<typename _Point, typename _Data>
+    uint32_t hashgrid<_Point, _Data>::bucket
+    (
+        int32_t x,
+        int32_t y,
+        int32_t z
+    )
+    const
+    {
+        const uint32_t h = ((uint32_t)x * 73856093u) ^
+                           ((uint32_t)y * 19349663u) ^
+                           ((uint32_t)z * 83492791u);
+        return h & _bucketMask;
+    }
+
+}